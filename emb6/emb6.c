@@ -68,6 +68,7 @@
 #include "ctimer.h"
 #include "rt_tmr.h"
 #include "random.h"
+#include "mmem.h"
 
 #if NETSTACK_CONF_WITH_IPV6
 #include "uip-ds6.h"
@@ -208,6 +209,12 @@ static void loc_set_status( e_stack_status_t status );
  * For further details have a look at the function definitions. */
 static void loc_event_callback( c_event_t ev, p_data_t data );
 
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+/* Get the time the main loop may block. For further information refer to
+ * the function definition. */
+static int32_t loc_waitTimeout( void );
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
+
 #if (NETSTK_CFG_LPM_ENABLED == TRUE)
 static int32_t loc_stackIdle(void)
 {
@@ -254,6 +261,86 @@ static int32_t loc_stackIdle(void)
  *  --- Local Functions ---------------------------------------------------- *
  */
 
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+/**
+ * \brief   Convert a number of timer ticks into microseconds.
+ *
+ * \param   ticks       Number of ticks.
+ * \param   usPerTick   Microseconds per tick.
+ *
+ * \return  Microseconds, limited to INT32_MAX.
+ */
+static int32_t loc_ticksToUs( uint32_t ticks, uint32_t usPerTick )
+{
+    if( ticks > (INT32_MAX / usPerTick) )
+        return INT32_MAX;
+
+    return (int32_t)(ticks * usPerTick);
+
+} /* loc_ticksToUs() */
+
+
+/**
+ * \brief   Get the time the main loop may block.
+ *
+ *          The main loop must not block as long as events are pending.
+ *          Otherwise it may sleep until the next event timer or real time
+ *          timer expires or, if no timer is running at all, until an input
+ *          arrives.
+ *
+ * \return  Timeout in microseconds, negative to wait forever.
+ */
+static int32_t loc_waitTimeout( void )
+{
+    st_evprocQueueStat_t s_stat;
+    s_rt_tmr_t* ps_rtTmr;
+    clock_time_t nextEvent;
+    clock_time_t now;
+    uint32_t ticks;
+    int32_t timeout = -1;
+    int32_t rtTimeout;
+    uint8_t i;
+
+    for( i = 0; i < E_EVPROC_PRIO_MAX; i++ )
+    {
+        if( (evproc_getQueueStat( (en_evprocPrio_t)i, &s_stat ) == E_SUCCESS) &&
+            (s_stat.i_depth > 0) )
+            return 0;
+    }
+
+    /* etimer_nextEvent() returns zero if no timer is pending */
+    nextEvent = etimer_nextEvent();
+    if( nextEvent != 0 )
+    {
+        now = bsp_getTick();
+        if( (int32_t)(nextEvent - now) <= 0 )
+            return 0;
+
+        /* one additional tick makes sure the timer has expired on wake up */
+        ticks = (uint32_t)(nextEvent - now) + 1;
+        timeout = loc_ticksToUs( ticks, 1000000UL / bsp_getTRes() );
+    }
+
+    /* the real time timers count ticks of their own */
+    ps_rtTmr = rt_tmr_getNext();
+    if( ps_rtTmr != NULL )
+    {
+        ticks = rt_tmr_getRemain( ps_rtTmr );
+        if( (int32_t)ticks <= 0 )
+            return 0;
+
+        rtTimeout = loc_ticksToUs( ticks,
+                1000000UL / RT_TMR_CFG_TICK_FREQ_IN_HZ );
+        if( (timeout < 0) || (rtTimeout < timeout) )
+            timeout = rtTimeout;
+    }
+
+    return timeout;
+
+} /* loc_waitTimeout() */
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
+
+
 
 /**
  * \brief   Initialize the network stack.
@@ -601,16 +688,31 @@ void emb6_init( s_ns_t* ps_ns, s_demo_t* ps_demos, e_nsErr_t* p_err )
 void emb6_process( int32_t us_delay )
 {
     uint8_t runLoop = (us_delay < 0) ? FALSE : TRUE;
+#if (HAL_SUPPORT_EVENTWAIT != TRUE)
     uint32_t delay = runLoop ? us_delay : 0;
+#endif /* #if (HAL_SUPPORT_EVENTWAIT != TRUE) */
 
     /* Attention: emb6 main process loop !! do not change !! */
     do
     {
         if( ps_stack != NULL )
         {
+#if MMEM_SEGREGATED
+          /* reclaim the fragmented managed memory while idle */
+          if( evproc_nextEvent() == E_QUEUE_EMPTY )
+          {
+              mmem_compact();
+          }
+#else
           evproc_nextEvent();
+#endif /* #if MMEM_SEGREGATED */
           etimer_request_poll();
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+          /* sleep until an input arrives or the next timer expires */
+          bsp_waitEvent( runLoop ? loc_waitTimeout() : 0 );
+#else
           bsp_delayUs(delay);
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
 
 #if (NETSTK_CFG_LPM_ENABLED == TRUE)
           /* low power manager handler entry */
@@ -281,6 +281,7 @@ typedef enum
     NETSTK_CMD_RF_CHAN_NUM_SET,
     NETSTK_CMD_RF_OP_MODE_SET,
     NETSTK_CMD_RF_WOR_EN,
+    NETSTK_CMD_RF_LQI_GET,
 
 } e_nsIocCmd_t;
 
@@ -717,6 +718,7 @@ extern const s_nsPHY_t phy_driver_802154;
 /* Supported rf drivers */
 extern const s_nsRF_t rf_driver_null;
 extern const s_nsRF_t rf_driver_native;
+extern const s_nsRF_t rf_driver_native_shm;
 extern const s_nsRF_t rf_driver_at212;
 extern const s_nsRF_t rf_driver_at212b;
 extern const s_nsRF_t rf_driver_ticc112x;
@@ -706,6 +706,19 @@
 #define UIP_UDP_CONNS                       10
 #endif /* UIP_CONF_UDP_CONNS */
 
+/**
+ * The number of buckets of the local port hash that demultiplexes
+ * incoming UDP datagrams and TCP segments. With 0, the connection
+ * tables are scanned instead.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_CONN_HASH_SIZE
+#define UIP_CONN_HASH_SIZE                  (UIP_CONF_CONN_HASH_SIZE)
+#else /* UIP_CONF_CONN_HASH_SIZE */
+#define UIP_CONN_HASH_SIZE                  0
+#endif /* UIP_CONF_CONN_HASH_SIZE */
+
 
 /**
  * Toggles whether TCP support should be compiled in or not.
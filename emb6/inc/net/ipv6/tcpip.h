@@ -354,6 +354,15 @@ void tcpip_set_outputfunc(uint8_t (* f)(void));
 void tcpip_ipv6_output(void);
 #endif
 
+#if NETSTACK_CONF_WITH_IPV6 && UIP_CONF_IPV6_QUEUE_PKT
+struct uip_ds6_nbr;
+/**
+ * \brief Send the packets queued for a neighbor during address resolution,
+ * oldest first. Overwrites uip_buf.
+ */
+void tcpip_ipv6_output_queued(struct uip_ds6_nbr *nbr);
+#endif
+
 /**
  * \brief Is forwarding generally enabled?
  */
@@ -89,6 +89,15 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB 4
 #endif /* UIP_CONF_MAX_ROUTES */
 
+/** \brief Index the routing table with a longest-prefix-match trie. A
+ *  lookup then no longer walks the whole table, at the cost of a trie
+ *  node pool of twice the routing table size. */
+#ifdef UIP_DS6_ROUTE_CONF_TRIE
+#define UIP_DS6_ROUTE_TRIE UIP_DS6_ROUTE_CONF_TRIE
+#else /* UIP_DS6_ROUTE_CONF_TRIE */
+#define UIP_DS6_ROUTE_TRIE 0
+#endif /* UIP_DS6_ROUTE_CONF_TRIE */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -148,6 +157,11 @@ struct uip_ds6_route_neighbor_routes {
 /** \brief An entry in the routing table */
 typedef struct uip_ds6_route {
   struct uip_ds6_route *next;
+#if UIP_DS6_ROUTE_TRIE
+  /* The indexed routing table is kept on a double linked list, so that
+     a lookup can move its route to the head in constant time. */
+  struct uip_ds6_route *prev;
+#endif /* UIP_DS6_ROUTE_TRIE */
   /* Each route entry belongs to a specific neighbor. That neighbor
      holds a list of all routing entries that go through it. The
      routes field point to the uip_ds6_route_neighbor_routes that
@@ -1,16 +1,36 @@
 /**
  * \file
- *         A brief description the file
+ *         Queues of outgoing packets waiting for a neighbor's link-layer
+ *         address to be resolved.
+ *
+ *         Each handle holds a FIFO of packets. The packets of all handles
+ *         are taken from a common pool of UIP_PACKETQUEUE_NUM buffers, a
+ *         single handle holds at most UIP_PACKETQUEUE_MAX_PER_HANDLE of
+ *         them. Every packet is discarded when its lifetime expires.
  */
 #ifndef UIP_PACKETQUEUE_H
 #define UIP_PACKETQUEUE_H
 
 #include "ctimer.h"
 
+/** Number of packet buffers shared by all queues */
+#ifdef UIP_PACKETQUEUE_CONF_NUM
+#define UIP_PACKETQUEUE_NUM UIP_PACKETQUEUE_CONF_NUM
+#else /* UIP_PACKETQUEUE_CONF_NUM */
+#define UIP_PACKETQUEUE_NUM 1
+#endif /* UIP_PACKETQUEUE_CONF_NUM */
+
+/** Maximum number of packets in a single queue */
+#ifdef UIP_PACKETQUEUE_CONF_MAX_PER_HANDLE
+#define UIP_PACKETQUEUE_MAX_PER_HANDLE UIP_PACKETQUEUE_CONF_MAX_PER_HANDLE
+#else /* UIP_PACKETQUEUE_CONF_MAX_PER_HANDLE */
+#define UIP_PACKETQUEUE_MAX_PER_HANDLE UIP_PACKETQUEUE_NUM
+#endif /* UIP_PACKETQUEUE_CONF_MAX_PER_HANDLE */
+
 struct uip_packetqueue_handle;
 
 struct uip_packetqueue_packet {
-  struct uip_ds6_queued_packet *next;
+  struct uip_packetqueue_packet *next;
   uint8_t queue_buf[UIP_BUFSIZE - UIP_LLH_LEN];
   uint16_t queue_buf_len;
   struct ctimer lifetimer;
@@ -18,21 +38,62 @@ struct uip_packetqueue_packet {
 };
 
 struct uip_packetqueue_handle {
+  /** The oldest packet of the queue, sent first */
   struct uip_packetqueue_packet *packet;
+  /** The number of packets in the queue */
+  uint8_t len;
 };
 
-void uip_packetqueue_new(struct uip_packetqueue_handle *handle);
+/** Packet queue counters */
+struct uip_packetqueue_stats {
+  uip_stats_t queued;   /**< Number of packets queued. */
+  uip_stats_t flushed;  /**< Number of packets taken out for sending. */
+  uip_stats_t expired;  /**< Number of packets whose lifetime ran out. */
+  uip_stats_t dropped;  /**< Number of packets refused because the queue
+                             or the pool was full, or discarded with
+                             their queue. */
+};
+
+extern struct uip_packetqueue_stats uip_packetqueue_stats;
 
+void uip_packetqueue_new(struct uip_packetqueue_handle *handle);
 
+/**
+ * Append an empty packet to a queue. Its contents are set through the
+ * returned packet or with uip_packetqueue_set_buflen().
+ */
 struct uip_packetqueue_packet *
 uip_packetqueue_alloc(struct uip_packetqueue_handle *handle, clock_time_t lifetime);
 
+/**
+ * Append a copy of a packet to a queue.
+ */
+struct uip_packetqueue_packet *
+uip_packetqueue_put(struct uip_packetqueue_handle *handle, clock_time_t lifetime,
+                    const void *data, uint16_t len);
+
+/**
+ * Remove the oldest packet of a queue after it has been sent.
+ */
+void
+uip_packetqueue_pop(struct uip_packetqueue_handle *handle);
 
+/**
+ * Discard all packets of a queue.
+ */
 void
 uip_packetqueue_free(struct uip_packetqueue_handle *handle);
 
+/**
+ * Check whether a packet can be appended to a queue, without counting a
+ * drop if not.
+ */
+int uip_packetqueue_can_put(struct uip_packetqueue_handle *handle);
+
+/** The oldest packet of a queue and its length, NULL and 0 if empty */
 uint8_t *uip_packetqueue_buf(struct uip_packetqueue_handle *h);
 uint16_t uip_packetqueue_buflen(struct uip_packetqueue_handle *h);
+/** Set the length of the packet appended last */
 void uip_packetqueue_set_buflen(struct uip_packetqueue_handle *h, uint16_t len);
 
 
@@ -850,6 +850,21 @@ CCIF void uip_send(const void *data, int len);
  */
 struct uip_udp_conn *uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport);
 
+#if UIP_CONN_HASH_SIZE
+/**
+ * Change the local port of a UDP connection.
+ *
+ * The connection is moved to the demultiplexing hash bucket of the new
+ * port. Port 0 releases the connection.
+ *
+ * \param conn A pointer to the uip_udp_conn structure for the
+ * connection.
+ *
+ * \param lport The local port number, in network byte order.
+ */
+void uip_udp_set_lport(struct uip_udp_conn *conn, uint16_t lport);
+#endif /* UIP_CONN_HASH_SIZE */
+
 /**
  * Remove a UDP connection.
  *
@@ -857,7 +872,11 @@ struct uip_udp_conn *uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport);
  *
  * \hideinitializer
  */
+#if UIP_CONN_HASH_SIZE
+#define uip_udp_remove(conn) uip_udp_set_lport(conn, 0)
+#else /* UIP_CONN_HASH_SIZE */
 #define uip_udp_remove(conn) (conn)->lport = 0
+#endif /* UIP_CONN_HASH_SIZE */
 
 /**
  * Bind a UDP connection to a local port.
@@ -869,7 +888,11 @@ struct uip_udp_conn *uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport);
  *
  * \hideinitializer
  */
+#if UIP_CONN_HASH_SIZE
+#define uip_udp_bind(conn, port) uip_udp_set_lport(conn, port)
+#else /* UIP_CONN_HASH_SIZE */
 #define uip_udp_bind(conn, port) (conn)->lport = port
+#endif /* UIP_CONN_HASH_SIZE */
 
 /**
  * Send a UDP datagram of length len on the current connection.
@@ -1360,6 +1383,10 @@ struct uip_conn {
              segment sent. */
 
   uip_tcp_appstate_t appstate; /** The application state. */
+#if UIP_CONN_HASH_SIZE
+  struct uip_conn *hnext; /**< The next connection in the same port
+             hash bucket. */
+#endif /* UIP_CONN_HASH_SIZE */
 };
 
 
@@ -1398,6 +1425,12 @@ struct uip_udp_conn {
 
   /** The application state. */
   uip_udp_appstate_t appstate;
+#if UIP_CONN_HASH_SIZE
+  /** The next connection in the same port hash bucket, or on the list
+      of unused connections. The local port must therefore only be
+      changed with uip_udp_bind() and uip_udp_remove(). */
+  struct uip_udp_conn *hnext;
+#endif /* UIP_CONN_HASH_SIZE */
 };
 
 /**
@@ -2227,6 +2260,43 @@ uint16_t uip_udpchksum(void);
  */
 uint16_t uip_icmp6chksum(void);
 
+/**
+ * Update a checksum after a 16-bit word it covers has changed.
+ *
+ * The new checksum is derived from the old one as described in RFC
+ * 1624, without summing the covered data again. All values are taken
+ * as stored in the packet.
+ *
+ * \param chksum The old checksum field.
+ *
+ * \param from The old value of the word.
+ *
+ * \param to The new value of the word.
+ *
+ * \return The new checksum field. Like a computed checksum, it may be
+ * 0 and has to be mapped to 0xffff for UDP.
+ */
+uint16_t uip_chksum_update16(uint16_t chksum, uint16_t from, uint16_t to);
+
+/**
+ * Update a checksum after a range of bytes it covers has changed.
+ *
+ * Same as uip_chksum_update16() for a range of 16-bit words, e.g. an
+ * IPv6 address of the pseudo header.
+ *
+ * \param chksum The old checksum field.
+ *
+ * \param from A pointer to the old contents of the range.
+ *
+ * \param to A pointer to the new contents of the range.
+ *
+ * \param len The length of the range, which must be even.
+ *
+ * \return The new checksum field.
+ */
+uint16_t uip_chksum_update(uint16_t chksum, const void *from, const void *to,
+                           uint16_t len);
+
 
 #endif /* UIP_H_ */
 
@@ -36,6 +36,22 @@
 
 struct udp_socket;
 
+/**
+ * Hand the received payload to the callback in place.
+ *
+ * By default the payload is copied to a buffer of the socket layer
+ * before the callback is invoked. If UDP_SOCKET_CONF_ZERO_COPY is set,
+ * the data pointer refers to the uIP buffer instead. The payload is
+ * then only valid until the callback sends a packet. It may be sent
+ * itself, e.g. to echo it, as the send moves it into place with
+ * memmove().
+ */
+#ifdef UDP_SOCKET_CONF_ZERO_COPY
+#define UDP_SOCKET_ZERO_COPY UDP_SOCKET_CONF_ZERO_COPY
+#else
+#define UDP_SOCKET_ZERO_COPY FALSE
+#endif /* #ifdef UDP_SOCKET_CONF_ZERO_COPY */
+
 /**
  * \brief      A UDP socket callback function
  * \param c    A pointer to the struct udp_socket that received the data
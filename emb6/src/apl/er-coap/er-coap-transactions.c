@@ -43,6 +43,7 @@
 #include "timer.h"
 #include "evproc.h"
 #include "memb.h"
+#include "dlist.h"
 #include "random.h"
 
 #include "tcpip.h"
@@ -66,7 +67,7 @@
 
 /*---------------------------------------------------------------------------*/
 MEMB(transactions_memb, coap_transaction_t, COAP_MAX_OPEN_TRANSACTIONS);
-LIST(transactions_list);
+DLIST(transactions_list);
 
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
@@ -84,7 +85,8 @@ coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint16_t port)
     t->addr = *addr;
     t->port = port;
 
-    list_add(transactions_list, t); /* list itself makes sure same element is not added twice */
+    dlist_item_init(t);
+    dlist_add(transactions_list, t);
   }
 
   return t;
@@ -148,7 +150,7 @@ coap_clear_transaction(coap_transaction_t *t)
     PRINTF("Freeing transaction %u: %p\n\r", t->mid, t);
 
     etimer_stop(&t->retrans_timer);
-    list_remove(transactions_list, t);
+    dlist_remove(transactions_list, t);
     memb_free(&transactions_memb, t);
   }
 }
@@ -157,7 +159,7 @@ coap_get_transaction_by_mid(uint16_t mid)
 {
   coap_transaction_t *t = NULL;
 
-  for(t = (coap_transaction_t *)list_head(transactions_list); t; t = t->next) {
+  for(t = (coap_transaction_t *)dlist_head(transactions_list); t; t = t->next) {
     if(t->mid == mid) {
       PRINTF("Found transaction for MID %u: %p\n\r", t->mid, t);
       return t;
@@ -171,7 +173,7 @@ coap_check_transactions()
 {
   coap_transaction_t *t = NULL;
 
-  for(t = (coap_transaction_t *)list_head(transactions_list); t; t = t->next) {
+  for(t = (coap_transaction_t *)dlist_head(transactions_list); t; t = t->next) {
     if(etimer_expired(&t->retrans_timer)) {
       ++(t->retrans_counter);
       PRINTF("Retransmitting %u (%u)\n\r", t->mid, t->retrans_counter);
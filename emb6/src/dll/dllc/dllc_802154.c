@@ -404,6 +404,9 @@ static void dllc_recv(uint8_t *p_data, uint16_t len, e_nsErr_t *p_err)
   frame802154_t frame;
   int hdrlen, ret;
   int8_t rssi;
+  uint8_t lqi = 0;
+  e_nsErr_t rssi_err;
+  e_nsErr_t lqi_err;
 
   /* store the received packet into internal packet buffer */
   packetbuf_clear();
@@ -430,9 +433,16 @@ static void dllc_recv(uint8_t *p_data, uint16_t len, e_nsErr_t *p_err)
     return;
   }
 
-  /* set packet buffer miscellaneous attributes */
-  pdllc_netstk->mac->ioctrl(NETSTK_CMD_RF_RSSI_GET, &rssi, p_err);
-  packetbuf_set_attr(PACKETBUF_ATTR_RSSI, rssi);
+  /* set packet buffer miscellaneous attributes, not all transceivers
+   * report a signal strength or a link quality */
+  pdllc_netstk->mac->ioctrl(NETSTK_CMD_RF_RSSI_GET, &rssi, &rssi_err);
+  if (rssi_err == NETSTK_ERR_NONE) {
+    packetbuf_set_attr(PACKETBUF_ATTR_RSSI, rssi);
+  }
+  pdllc_netstk->mac->ioctrl(NETSTK_CMD_RF_LQI_GET, &lqi, &lqi_err);
+  if (lqi_err == NETSTK_ERR_NONE) {
+    packetbuf_set_attr(PACKETBUF_ATTR_LINK_QUALITY, lqi);
+  }
 
   /* signal next higher layer of the valid received frame */
   if (dllc_cbRxFnct) {
@@ -748,7 +748,10 @@ static void mac_rxBufTimeout(s_rt_tmr_t *p_tmr, e_nsErr_t *p_err)
 
   /* start polling timer */
   rt_tmr_stop(p_tmr);
-  rt_tmr_start(p_tmr);
+  if (rt_tmr_start(p_tmr) != E_RT_TMR_ERR_NONE) {
+    *p_err = NETSTK_ERR_FATAL;
+    return;
+  }
   mac_hasData = 0;
   do {
     /* check if RF is in reception process */
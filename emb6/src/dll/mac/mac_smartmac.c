@@ -264,7 +264,10 @@ static void smartmac_start(e_nsErr_t *p_err) {
   struct s_smartmac *p_ctx = &smartmac;
 
   /* start wake-up timer */
-  rt_tmr_start(&p_ctx->tmrWakeup);
+  if (rt_tmr_start(&p_ctx->tmrWakeup) != E_RT_TMR_ERR_NONE) {
+    *p_err = NETSTK_ERR_FATAL;
+    return;
+  }
   *p_err = NETSTK_ERR_NONE;
 }
 
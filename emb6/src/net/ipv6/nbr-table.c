@@ -87,6 +87,21 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_HASH_SIZE
+#if NBR_TABLE_HASH_SIZE <= NBR_TABLE_MAX_NEIGHBORS
+#error "NBR_TABLE_CONF_HASH_SIZE must exceed NBR_TABLE_CONF_MAX_NEIGHBORS"
+#endif
+#if NBR_TABLE_MAX_NEIGHBORS < 255
+typedef uint8_t nbr_table_slot_t;
+#else
+typedef uint16_t nbr_table_slot_t;
+#endif
+/* Linear probing hash of the link-layer addresses in nbr_table_keys. A slot
+ * holds the neighbor index plus one, 0 marks a free slot. As there are more
+ * slots than neighbors, a probe always ends on a free slot. */
+static nbr_table_slot_t lladdr_hash[NBR_TABLE_HASH_SIZE];
+#endif /* NBR_TABLE_HASH_SIZE */
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -129,17 +144,91 @@ key_from_item(nbr_table_t *table, const nbr_table_item_t *item)
 {
   return key_from_index(index_from_item(table, item));
 }
+#if NBR_TABLE_HASH_SIZE
+/*---------------------------------------------------------------------------*/
+/* Get the home slot of a link-layer address (FNV-1a) */
+static unsigned
+lladdr_hash_home(const linkaddr_t *lladdr)
+{
+  uint32_t h = 2166136261UL;
+  unsigned i;
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    h ^= lladdr->u8[i];
+    h *= 16777619UL;
+  }
+  return h % NBR_TABLE_HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+/* Get the slot holding a link-layer address, or the free slot ending its
+ * probe sequence */
+static unsigned
+lladdr_hash_slot(const linkaddr_t *lladdr)
+{
+  unsigned slot = lladdr_hash_home(lladdr);
+  while(lladdr_hash[slot] != 0 &&
+        !linkaddr_cmp(lladdr, &key_from_index(lladdr_hash[slot] - 1)->lladdr)) {
+    if(++slot == NBR_TABLE_HASH_SIZE) {
+      slot = 0;
+    }
+  }
+  return slot;
+}
+/*---------------------------------------------------------------------------*/
+/* Enter a key into the hash, under its current link-layer address */
+static void
+lladdr_hash_insert(nbr_table_key_t *key)
+{
+  lladdr_hash[lladdr_hash_slot(&key->lladdr)] = index_from_key(key) + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a key from the hash, before its link-layer address changes. The
+ * following entries of the probe sequence are shifted back into the gap,
+ * so that no tombstones are needed. */
+static void
+lladdr_hash_remove(nbr_table_key_t *key)
+{
+  unsigned gap = lladdr_hash_slot(&key->lladdr);
+  unsigned slot = gap;
+  unsigned home;
+
+  if(lladdr_hash[gap] == 0) {
+    return;
+  }
+  lladdr_hash[gap] = 0;
+  for(;;) {
+    if(++slot == NBR_TABLE_HASH_SIZE) {
+      slot = 0;
+    }
+    if(lladdr_hash[slot] == 0) {
+      return;
+    }
+    home = lladdr_hash_home(&key_from_index(lladdr_hash[slot] - 1)->lladdr);
+    /* An entry whose home lies cyclically in (gap, slot] stays */
+    if(gap <= slot ? (gap < home && home <= slot) : (gap < home || home <= slot)) {
+      continue;
+    }
+    lladdr_hash[gap] = lladdr_hash[slot];
+    lladdr_hash[slot] = 0;
+    gap = slot;
+  }
+}
+#endif /* NBR_TABLE_HASH_SIZE */
 /*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const linkaddr_t *lladdr)
 {
+#if !NBR_TABLE_HASH_SIZE
   nbr_table_key_t *key;
+#endif
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by linkaddr_null. */
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
+#if NBR_TABLE_HASH_SIZE
+  return (int)lladdr_hash[lladdr_hash_slot(lladdr)] - 1;
+#else
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
@@ -148,6 +237,7 @@ index_from_lladdr(const linkaddr_t *lladdr)
     key = list_item_next(key);
   }
   return -1;
+#endif /* NBR_TABLE_HASH_SIZE */
 }
 /*---------------------------------------------------------------------------*/
 /* Get bit from "used" or "locked" bitmap */
@@ -194,6 +284,9 @@ remove_key(nbr_table_key_t *least_used_key)
   }
   /* Empty used map */
   used_map[index_from_key(least_used_key)] = 0;
+#if NBR_TABLE_HASH_SIZE
+  lladdr_hash_remove(least_used_key);
+#endif
   /* Remove neighbor from list */
   list_remove(nbr_table_keys, least_used_key);
 }
@@ -297,6 +390,9 @@ nbr_table_init(void)
 
   memb_init(&neighbor_addr_mem);
   list_init(nbr_table_keys);
+#if NBR_TABLE_HASH_SIZE
+  memset(lladdr_hash, 0, sizeof(lladdr_hash));
+#endif
 }
 /*---------------------------------------------------------------------------*/
 /* Register a new neighbor table. To be used at initialization by modules
@@ -380,6 +476,9 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr, nbr_table_rea
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_HASH_SIZE
+    lladdr_hash_insert(key);
+#endif
   }
 
   /* Get item in the current table */
@@ -471,7 +570,13 @@ nbr_table_update_lladdr(const linkaddr_t *old_addr, const linkaddr_t *new_addr,
    * Copy the new lladdr into the key - since we know that there is no
    * conflicting entry.
    */
+#if NBR_TABLE_HASH_SIZE
+  lladdr_hash_remove(key);
+#endif
   memcpy(&key->lladdr, new_addr, sizeof(linkaddr_t));
+#if NBR_TABLE_HASH_SIZE
+  lladdr_hash_insert(key);
+#endif
   return 1;
 }
 /*---------------------------------------------------------------------------*/
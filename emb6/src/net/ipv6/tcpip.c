@@ -494,6 +494,20 @@ tcpip_input(void)
     uip_clear_buf();
 }
 /*---------------------------------------------------------------------------*/
+#if NETSTACK_CONF_WITH_IPV6 && UIP_CONF_IPV6_QUEUE_PKT
+void
+tcpip_ipv6_output_queued(struct uip_ds6_nbr *nbr)
+{
+  while(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
+    uip_len = uip_packetqueue_buflen(&nbr->packethandle);
+    memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
+    uip_packetqueue_pop(&nbr->packethandle);
+    tcpip_output(uip_ds6_nbr_get_ll(nbr));
+  }
+  uip_clear_buf();
+}
+#endif /* NETSTACK_CONF_WITH_IPV6 && UIP_CONF_IPV6_QUEUE_PKT */
+/*---------------------------------------------------------------------------*/
 #if NETSTACK_CONF_WITH_IPV6
 void
 tcpip_ipv6_output(void)
@@ -639,10 +653,8 @@ tcpip_ipv6_output(void)
       } else {
 #if UIP_CONF_IPV6_QUEUE_PKT
         /* Copy outgoing pkt in the queuing buffer for later transmit. */
-        if(uip_packetqueue_alloc(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME) != NULL) {
-          memcpy(uip_packetqueue_buf(&nbr->packethandle), UIP_IP_BUF, uip_len);
-          uip_packetqueue_set_buflen(&nbr->packethandle, uip_len);
-        }
+        uip_packetqueue_put(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME,
+                            UIP_IP_BUF, uip_len);
 #endif
       /* RFC4861, 7.2.2:
        * "If the source address of the packet prompting the solicitation is the
@@ -670,12 +682,9 @@ tcpip_ipv6_output(void)
       if(nbr->state == NBR_INCOMPLETE) {
         PRINTF("tcpip_ipv6_output: nbr cache entry incomplete\n\r");
 #if UIP_CONF_IPV6_QUEUE_PKT
-        /* Copy outgoing pkt in the queuing buffer for later transmit and set
-           the destination nbr to nbr. */
-        if(uip_packetqueue_alloc(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME) != NULL) {
-          memcpy(uip_packetqueue_buf(&nbr->packethandle), UIP_IP_BUF, uip_len);
-          uip_packetqueue_set_buflen(&nbr->packethandle, uip_len);
-        }
+        /* Append outgoing pkt to the queue of the nbr for later transmit. */
+        uip_packetqueue_put(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME,
+                            UIP_IP_BUF, uip_len);
 #endif /*UIP_CONF_IPV6_QUEUE_PKT*/
         uip_clear_buf();
         return;
@@ -690,20 +699,29 @@ tcpip_ipv6_output(void)
       }
 #endif /* UIP_ND6_SEND_NA */
 
-      tcpip_output(uip_ds6_nbr_get_ll(nbr));
-
 #if UIP_CONF_IPV6_QUEUE_PKT
       /*
        * Send the queued packets from here, may not be 100% perfect though.
        * This happens in a few cases, for example when instead of receiving a
        * NA after sendiong a NS, you receive a NS with SLLAO: the entry moves
-       * to STALE, and you must both send a NA and the queued packet.
+       * to STALE, and you must both send a NA and the queued packets. The
+       * current packet is appended to keep the order, unless the queue is
+       * full. It is sent directly then, which is not a drop.
        */
+      if(uip_packetqueue_buflen(&nbr->packethandle) != 0 &&
+         uip_packetqueue_can_put(&nbr->packethandle) &&
+         uip_packetqueue_put(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME,
+                             UIP_IP_BUF, uip_len) != NULL) {
+        tcpip_ipv6_output_queued(nbr);
+        return;
+      }
+#endif /*UIP_CONF_IPV6_QUEUE_PKT*/
+
+      tcpip_output(uip_ds6_nbr_get_ll(nbr));
+
+#if UIP_CONF_IPV6_QUEUE_PKT
       if(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
-        uip_len = uip_packetqueue_buflen(&nbr->packethandle);
-        memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-        uip_packetqueue_free(&nbr->packethandle);
-        tcpip_output(uip_ds6_nbr_get_ll(nbr));
+        tcpip_ipv6_output_queued(nbr);
       }
 #endif /*UIP_CONF_IPV6_QUEUE_PKT*/
 
@@ -43,6 +43,7 @@
 #include "uip.h"
 
 #include "clist.h"
+#include "dlist.h"
 #include "memb.h"
 #include "nbr-table.h"
 
@@ -70,9 +71,43 @@ MEMB(neighborroutememb, struct uip_ds6_route_neighbor_route, UIP_DS6_ROUTE_NB);
 /* Each route is repressented by a uip_ds6_route_t structure and
    memory for each route is allocated from the routememb memory
    block. These routes are maintained on the routelist. */
+#if UIP_DS6_ROUTE_TRIE
+DLIST(routelist);
+#define ROUTELIST_INIT()      dlist_init(routelist)
+#define ROUTELIST_HEAD()      dlist_head(routelist)
+#define ROUTELIST_TAIL()      dlist_tail(routelist)
+#define ROUTELIST_PUSH(r)     dlist_push(routelist, r)
+#define ROUTELIST_REMOVE(r)   dlist_remove(routelist, r)
+#else /* UIP_DS6_ROUTE_TRIE */
 LIST(routelist);
+#define ROUTELIST_INIT()      list_init(routelist)
+#define ROUTELIST_HEAD()      list_head(routelist)
+#define ROUTELIST_TAIL()      list_tail(routelist)
+#define ROUTELIST_PUSH(r)     list_push(routelist, r)
+#define ROUTELIST_REMOVE(r)   list_remove(routelist, r)
+#endif /* UIP_DS6_ROUTE_TRIE */
 MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 
+#if UIP_DS6_ROUTE_TRIE
+/* The routes are additionally indexed by a path compressed binary trie
+   over their prefix bits. Each trie node either holds a route or
+   branches into two subtries, hence the trie never needs more than
+   2 * UIP_DS6_ROUTE_NB - 1 nodes and a lookup visits at most one node
+   per prefix on the path to the destination, whatever the number of
+   routes. Routes to the very same prefix share one node; the node
+   points to the most recently added one and counts the others in
+   shadowed. */
+struct route_tnode {
+  struct route_tnode *child[2];
+  uip_ds6_route_t *route;
+  uip_ipaddr_t prefix;
+  uint8_t length;
+  uint8_t shadowed;
+};
+MEMB(routetnodememb, struct route_tnode, 2 * UIP_DS6_ROUTE_NB);
+static struct route_tnode *routetrie;
+#endif /* UIP_DS6_ROUTE_TRIE */
+
 static int num_routes = 0;
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 
@@ -156,13 +191,201 @@ uip_ds6_notification_rm(struct uip_ds6_notification *n)
   list_remove(notificationlist, n);
 }
 #endif
+#if (UIP_CONF_MAX_ROUTES != 0) && UIP_DS6_ROUTE_TRIE
+/*---------------------------------------------------------------------------*/
+static uint8_t
+route_trie_bit(const uip_ipaddr_t *addr, uint8_t pos)
+{
+  return (addr->u8[pos >> 3] >> (7 - (pos & 7))) & 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the number of leading bits, up to max, that a and b have in
+   common. The bits before from are known to be equal already. */
+static uint8_t
+route_trie_cpl(const uip_ipaddr_t *a, const uip_ipaddr_t *b,
+               uint8_t from, uint8_t max)
+{
+  uint8_t len;
+  uint8_t diff;
+
+  for(len = from & ~7; len < max; len += 8) {
+    diff = a->u8[len >> 3] ^ b->u8[len >> 3];
+    if(diff != 0) {
+      while((diff & 0x80) == 0) {
+        diff <<= 1;
+        len++;
+      }
+      break;
+    }
+  }
+  return len < max ? len : max;
+}
+/*---------------------------------------------------------------------------*/
+static struct route_tnode *
+route_trie_node(const uip_ipaddr_t *prefix, uint8_t length,
+                uip_ds6_route_t *route)
+{
+  struct route_tnode *n;
+
+  n = memb_alloc(&routetnodememb);
+  if(n != NULL) {
+    n->child[0] = NULL;
+    n->child[1] = NULL;
+    n->route = route;
+    uip_ipaddr_copy(&n->prefix, prefix);
+    n->length = length;
+    n->shadowed = 0;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+route_trie_lookup(const uip_ipaddr_t *addr)
+{
+  struct route_tnode *n;
+  uip_ds6_route_t *found_route;
+  uint8_t matched;
+
+  found_route = NULL;
+  matched = 0;
+  for(n = routetrie;
+      n != NULL && route_trie_cpl(addr, &n->prefix, matched, n->length) == n->length;
+      n = n->child[route_trie_bit(addr, matched)]) {
+    if(n->route != NULL) {
+      found_route = n->route;
+    }
+    if(n->length == 128) {
+      break;
+    }
+    matched = n->length;
+  }
+  return found_route;
+}
+/*---------------------------------------------------------------------------*/
+static void
+route_trie_insert(uip_ds6_route_t *route)
+{
+  struct route_tnode **link;
+  struct route_tnode *n;
+  struct route_tnode *leaf;
+  struct route_tnode *branch;
+  uint8_t length;
+  uint8_t matched;
+  uint8_t cpl;
+
+  length = route->length < 128 ? route->length : 128;
+  matched = 0;
+  for(link = &routetrie; (n = *link) != NULL;
+      link = &n->child[route_trie_bit(&route->ipaddr, matched)]) {
+    cpl = route_trie_cpl(&route->ipaddr, &n->prefix, matched,
+                         n->length < length ? n->length : length);
+    if(cpl < n->length) {
+      /* The new prefix ends or diverges inside the prefix of n. */
+      break;
+    }
+    if(n->length == length) {
+      if(n->route != NULL) {
+        n->shadowed++;
+      }
+      n->route = route;
+      return;
+    }
+    matched = n->length;
+  }
+
+  leaf = route_trie_node(&route->ipaddr, length, route);
+  if(leaf == NULL) {
+    PRINTF("uip-ds6-route: trie node pool exhausted\n\r");
+    return;
+  }
+  if(n == NULL) {
+    *link = leaf;
+  } else if(cpl == length) {
+    /* The new route covers n. */
+    leaf->child[route_trie_bit(&n->prefix, length)] = n;
+    *link = leaf;
+  } else {
+    /* Both hang below a new branch at the first differing bit. */
+    branch = route_trie_node(&route->ipaddr, cpl, NULL);
+    if(branch == NULL) {
+      PRINTF("uip-ds6-route: trie node pool exhausted\n\r");
+      memb_free(&routetnodememb, leaf);
+      return;
+    }
+    branch->child[route_trie_bit(&route->ipaddr, cpl)] = leaf;
+    branch->child[route_trie_bit(&n->prefix, cpl)] = n;
+    *link = branch;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+route_trie_remove(uip_ds6_route_t *route)
+{
+  struct route_tnode **link;
+  struct route_tnode **parent;
+  struct route_tnode *n;
+  uip_ds6_route_t *r;
+  uint8_t length;
+
+  length = route->length < 128 ? route->length : 128;
+  parent = NULL;
+  for(link = &routetrie; (n = *link) != NULL && n->length < length;
+      link = &n->child[route_trie_bit(&route->ipaddr, n->length)]) {
+    parent = link;
+  }
+  if(n == NULL || n->length != length ||
+     route_trie_cpl(&route->ipaddr, &n->prefix, 0, length) != length) {
+    return;
+  }
+
+  if(n->route != route) {
+    /* The route was shadowed by another one to the same prefix. */
+    if(n->shadowed > 0) {
+      n->shadowed--;
+    }
+    return;
+  }
+
+  n->route = NULL;
+  if(n->shadowed > 0) {
+    /* Promote one of the shadowed routes. This only happens when a
+       prefix was added twice, so scanning the list is acceptable. */
+    n->shadowed--;
+    for(r = ROUTELIST_HEAD(); r != NULL; r = list_item_next(r)) {
+      if(r != route && r->length == route->length &&
+         route_trie_cpl(&r->ipaddr, &n->prefix, 0, length) == length) {
+        n->route = r;
+        return;
+      }
+    }
+  }
+
+  /* A node without a route is only kept while it branches. */
+  if(n->child[0] != NULL && n->child[1] != NULL) {
+    return;
+  }
+  *link = n->child[0] != NULL ? n->child[0] : n->child[1];
+  memb_free(&routetnodememb, n);
+
+  /* Removing a leaf may leave its parent branching to a single child. */
+  if(*link == NULL && parent != NULL && (*parent)->route == NULL) {
+    n = *parent;
+    *parent = n->child[0] != NULL ? n->child[0] : n->child[1];
+    memb_free(&routetnodememb, n);
+  }
+}
+#endif /* (UIP_CONF_MAX_ROUTES != 0) && UIP_DS6_ROUTE_TRIE */
 /*---------------------------------------------------------------------------*/
 void
 uip_ds6_route_init(void)
 {
 #if (UIP_CONF_MAX_ROUTES != 0)
   memb_init(&routememb);
-  list_init(routelist);
+  ROUTELIST_INIT();
+#if UIP_DS6_ROUTE_TRIE
+  memb_init(&routetnodememb);
+  routetrie = NULL;
+#endif /* UIP_DS6_ROUTE_TRIE */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
@@ -206,7 +429,7 @@ uip_ds6_route_t *
 uip_ds6_route_head(void)
 {
 #if (UIP_CONF_MAX_ROUTES != 0)
-    return list_head(routelist);
+    return ROUTELIST_HEAD();
 #else /* (UIP_CONF_MAX_ROUTES != 0) */
   return NULL;
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
@@ -255,15 +478,20 @@ uip_ds6_route_t *
 uip_ds6_route_lookup(uip_ipaddr_t *addr)
 {
 #if (UIP_CONF_MAX_ROUTES != 0)
-  uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
+#if !UIP_DS6_ROUTE_TRIE
+  uip_ds6_route_t *r;
   uint8_t longestmatch;
+#endif /* !UIP_DS6_ROUTE_TRIE */
 
   PRINTF("uip-ds6-route: Looking up route for ");
   PRINT6ADDR(addr);
   PRINTF("\n\r");
 
 
+#if UIP_DS6_ROUTE_TRIE
+  found_route = route_trie_lookup(addr);
+#else /* UIP_DS6_ROUTE_TRIE */
   found_route = NULL;
   longestmatch = 0;
   for(r = uip_ds6_route_head();
@@ -281,6 +509,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
             }
         }
   }
+#endif /* UIP_DS6_ROUTE_TRIE */
 
   if(found_route != NULL) {
     PRINTF("uip-ds6-route: Found route: ");
@@ -292,13 +521,13 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     PRINTF("uip-ds6-route: No route found\n\r");
   }
 
-  if(found_route != NULL && found_route != list_head(routelist)) {
+  if(found_route != NULL && found_route != ROUTELIST_HEAD()) {
       /* If we found a route, we put it at the start of the routeslist
          list. The list is ordered by how recently we looked them up:
          the least recently used route will be at the end of the
          list - for fast lookups (assuming multiple packets to the same node). */
-      list_remove(routelist, found_route);
-      list_push(routelist, found_route);
+      ROUTELIST_REMOVE(found_route);
+      ROUTELIST_PUSH(found_route);
   }
 
   return found_route;
@@ -367,7 +596,7 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 #if UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
         /* Removing the oldest route entry from the route table. The
              least recently used route is the first route on the list. */
-    	oldest = list_tail(routelist);
+    	oldest = ROUTELIST_TAIL();
     	#endif
     	if(oldest == NULL) {
     	  return NULL;
@@ -421,15 +650,20 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
       return NULL;
     }
 
+#if UIP_DS6_ROUTE_TRIE
+    dlist_item_init(r);
+#endif /* UIP_DS6_ROUTE_TRIE */
+
     /* add new routes first - assuming that there is a reason to add this
            and that there is a packet coming soon. */
-    list_push(routelist, r);
+    ROUTELIST_PUSH(r);
 
     nbrr = memb_alloc(&neighborroutememb);
     if(nbrr == NULL) {
         /* This should not happen, as we explicitly deallocated one
              route table entry above. */
         PRINTF("uip_ds6_route_add: could not allocate neighbor route list entry\n");
+        ROUTELIST_REMOVE(r);
         memb_free(&routememb, r);
         return NULL;
     }
@@ -448,6 +682,9 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
+#if UIP_DS6_ROUTE_TRIE
+  route_trie_insert(r);
+#endif /* UIP_DS6_ROUTE_TRIE */
 
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
@@ -490,7 +727,10 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
     PRINTF("\n\r");
 
     /* Remove the route from the route list */
-    list_remove(routelist, route);
+    ROUTELIST_REMOVE(route);
+#if UIP_DS6_ROUTE_TRIE
+    route_trie_remove(route);
+#endif /* UIP_DS6_ROUTE_TRIE */
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
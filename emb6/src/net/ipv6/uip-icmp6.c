@@ -120,6 +120,11 @@ uip_icmp6_register_input_handler(uip_icmp6_input_handler_t *handler)
 static void
 echo_request_input(void)
 {
+#if UIP_CONF_IPV6_CHECKS
+  uint16_t chksum;
+  uint16_t type_code;
+#endif /* UIP_CONF_IPV6_CHECKS */
+
   /*
    * we send an echo reply. It is trivial if there was no extension
    * headers in the request otherwise we need to remove the extension
@@ -131,12 +136,28 @@ echo_request_input(void)
   PRINT6ADDR(&UIP_IP_BUF->destipaddr);
   PRINTF("\n");
 
+#if UIP_CONF_IPV6_CHECKS
+  /* The checksum of the request has been verified, the one of the reply
+   * is derived from it instead of summing the payload again. Swapping the
+   * addresses leaves the pseudo header sum unchanged. */
+  chksum = UIP_ICMP_BUF->icmpchksum;
+  memcpy(&type_code, &UIP_ICMP_BUF->type, sizeof(type_code));
+#endif /* UIP_CONF_IPV6_CHECKS */
+
   /* IP header */
   UIP_IP_BUF->ttl = uip_ds6_if.cur_hop_limit;
 
   if(uip_is_addr_mcast(&UIP_IP_BUF->destipaddr)){
+#if UIP_CONF_IPV6_CHECKS
+    uip_ipaddr_copy(&tmp_ipaddr, &UIP_IP_BUF->destipaddr);
+#endif /* UIP_CONF_IPV6_CHECKS */
     uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &UIP_IP_BUF->srcipaddr);
     uip_ds6_select_src(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
+#if UIP_CONF_IPV6_CHECKS
+    /* The multicast destination is replaced by the selected source */
+    chksum = uip_chksum_update(chksum, &tmp_ipaddr, &UIP_IP_BUF->srcipaddr,
+                               sizeof(uip_ipaddr_t));
+#endif /* UIP_CONF_IPV6_CHECKS */
   } else {
     uip_ipaddr_copy(&tmp_ipaddr, &UIP_IP_BUF->srcipaddr);
     uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
@@ -167,8 +188,14 @@ echo_request_input(void)
   /* Note: now UIP_ICMP_BUF points to the beginning of the echo reply */
   UIP_ICMP_BUF->type = ICMP6_ECHO_REPLY;
   UIP_ICMP_BUF->icode = 0;
+#if UIP_CONF_IPV6_CHECKS
+  UIP_ICMP_BUF->icmpchksum = uip_chksum_update(chksum, &type_code,
+                                               &UIP_ICMP_BUF->type,
+                                               sizeof(type_code));
+#else /* UIP_CONF_IPV6_CHECKS */
   UIP_ICMP_BUF->icmpchksum = 0;
   UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
+#endif /* UIP_CONF_IPV6_CHECKS */
 
   PRINTF("Sending Echo Reply to ");
   PRINT6ADDR(&UIP_IP_BUF->destipaddr);
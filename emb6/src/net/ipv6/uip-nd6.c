@@ -580,9 +580,7 @@ na_input(void)
     return;
     }*/
   if(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
-    uip_len = uip_packetqueue_buflen(&nbr->packethandle);
-    memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+    tcpip_ipv6_output_queued(nbr);
     return;
   }
   
@@ -1068,9 +1066,7 @@ ra_input(void)
     return;
     }*/
   if(nbr != NULL && uip_packetqueue_buflen(&nbr->packethandle) != 0) {
-    uip_len = uip_packetqueue_buflen(&nbr->packethandle);
-    memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+    tcpip_ipv6_output_queued(nbr);
     return;
   }
 
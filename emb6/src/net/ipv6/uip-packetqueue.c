@@ -1,8 +1,10 @@
 /**
  * \file
- *         A brief description the file
+ *         Queues of outgoing packets waiting for a neighbor's link-layer
+ *         address to be resolved.
  */
 #include <stdio.h>
+#include <string.h>
 
 #include "uip.h"
 
@@ -10,8 +12,9 @@
 
 #include "uip-packetqueue.h"
 
-#define MAX_NUM_QUEUED_PACKETS 1
-MEMB(packets_memb, struct uip_packetqueue_packet, MAX_NUM_QUEUED_PACKETS);
+MEMB(packets_memb, struct uip_packetqueue_packet, UIP_PACKETQUEUE_NUM);
+
+struct uip_packetqueue_stats uip_packetqueue_stats;
 
 #define DEBUG DEBUG_NONE
 #if DEBUG
@@ -21,15 +24,45 @@ MEMB(packets_memb, struct uip_packetqueue_packet, MAX_NUM_QUEUED_PACKETS);
 #define PRINTF(...)
 #endif
 
+/*---------------------------------------------------------------------------*/
+/* Get the last packet of a queue */
+static struct uip_packetqueue_packet *
+packet_tail(struct uip_packetqueue_handle *h)
+{
+  struct uip_packetqueue_packet *p = h->packet;
+
+  while(p != NULL && p->next != NULL) {
+    p = p->next;
+  }
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+/* Unlink a packet from its queue and release it */
+static void
+packet_remove(struct uip_packetqueue_packet *p)
+{
+  struct uip_packetqueue_handle *h = p->handle;
+  struct uip_packetqueue_packet **pp;
+
+  for(pp = &h->packet; *pp != NULL; pp = &(*pp)->next) {
+    if(*pp == p) {
+      *pp = p->next;
+      h->len--;
+      break;
+    }
+  }
+  ctimer_stop(&p->lifetimer);
+  memb_free(&packets_memb, p);
+}
 /*---------------------------------------------------------------------------*/
 static void
 packet_timedout(void *ptr)
 {
-  struct uip_packetqueue_handle *h = ptr;
+  struct uip_packetqueue_packet *p = ptr;
 
-  PRINTF("uip_packetqueue_free timed out %p\n", h);
-  memb_free(&packets_memb, h->packet);
-  h->packet = NULL;
+  PRINTF("uip_packetqueue_free timed out %p\n", p->handle);
+  uip_packetqueue_stats.expired++;
+  packet_remove(p);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -37,37 +70,88 @@ uip_packetqueue_new(struct uip_packetqueue_handle *handle)
 {
   PRINTF("uip_packetqueue_new %p\n", handle);
   handle->packet = NULL;
+  handle->len = 0;
 }
 /*---------------------------------------------------------------------------*/
 struct uip_packetqueue_packet *
 uip_packetqueue_alloc(struct uip_packetqueue_handle *handle, clock_time_t lifetime)
 {
+  struct uip_packetqueue_packet *p;
+  struct uip_packetqueue_packet *tail;
+
   PRINTF("uip_packetqueue_alloc %p\n", handle);
-  if(handle->packet != NULL) {
-    PRINTF("alloced\n");
+  if(handle->len >= UIP_PACKETQUEUE_MAX_PER_HANDLE) {
+    PRINTF("queue full\n");
+    uip_packetqueue_stats.dropped++;
     return NULL;
   }
-  handle->packet = memb_alloc(&packets_memb);
-  if(handle->packet != NULL) {
-    ctimer_set(&handle->packet->lifetimer, lifetime,
-               packet_timedout, handle);
-  } else {
+  p = memb_alloc(&packets_memb);
+  if(p == NULL) {
     PRINTF("uip_packetqueue_alloc failed\n");
+    uip_packetqueue_stats.dropped++;
+    return NULL;
+  }
+
+  p->next = NULL;
+  p->queue_buf_len = 0;
+  p->handle = handle;
+  tail = packet_tail(handle);
+  if(tail == NULL) {
+    handle->packet = p;
+  } else {
+    tail->next = p;
+  }
+  handle->len++;
+  ctimer_set(&p->lifetimer, lifetime, packet_timedout, p);
+  uip_packetqueue_stats.queued++;
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+struct uip_packetqueue_packet *
+uip_packetqueue_put(struct uip_packetqueue_handle *handle, clock_time_t lifetime,
+                    const void *data, uint16_t len)
+{
+  struct uip_packetqueue_packet *p;
+
+  if(len > sizeof(p->queue_buf)) {
+    uip_packetqueue_stats.dropped++;
+    return NULL;
+  }
+  p = uip_packetqueue_alloc(handle, lifetime);
+  if(p != NULL) {
+    memcpy(p->queue_buf, data, len);
+    p->queue_buf_len = len;
+  }
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_packetqueue_pop(struct uip_packetqueue_handle *handle)
+{
+  PRINTF("uip_packetqueue_pop %p\n", handle);
+  if(handle->packet != NULL) {
+    uip_packetqueue_stats.flushed++;
+    packet_remove(handle->packet);
   }
-  return handle->packet;
 }
 /*---------------------------------------------------------------------------*/
 void
 uip_packetqueue_free(struct uip_packetqueue_handle *handle)
 {
   PRINTF("uip_packetqueue_free %p\n", handle);
-  if(handle->packet != NULL) {
-    ctimer_stop(&handle->packet->lifetimer);
-    memb_free(&packets_memb, handle->packet);
-    handle->packet = NULL;
+  while(handle->packet != NULL) {
+    uip_packetqueue_stats.dropped++;
+    packet_remove(handle->packet);
   }
 }
 /*---------------------------------------------------------------------------*/
+int
+uip_packetqueue_can_put(struct uip_packetqueue_handle *handle)
+{
+  return handle->len < UIP_PACKETQUEUE_MAX_PER_HANDLE &&
+         memb_numfree(&packets_memb) > 0;
+}
+/*---------------------------------------------------------------------------*/
 uint8_t *
 uip_packetqueue_buf(struct uip_packetqueue_handle *h)
 {
@@ -83,8 +167,10 @@ uip_packetqueue_buflen(struct uip_packetqueue_handle *h)
 void
 uip_packetqueue_set_buflen(struct uip_packetqueue_handle *h, uint16_t len)
 {
-  if(h->packet != NULL) {
-    h->packet->queue_buf_len = len;
+  struct uip_packetqueue_packet *p = packet_tail(h);
+
+  if(p != NULL) {
+    p->queue_buf_len = len;
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -261,6 +261,12 @@ static uint8_t iss[4];
 
 /* Temporary variables. */
 uint8_t uip_acc32[4];
+
+#if UIP_CONN_HASH_SIZE
+/* The TCP connections chained by the hash of their local port. Closed
+   connections stay in their bucket until they are reused. */
+static struct uip_conn *uip_conn_hash[UIP_CONN_HASH_SIZE];
+#endif /* UIP_CONN_HASH_SIZE */
 #endif /* UIP_TCP */
 /** @} */
 
@@ -273,9 +279,22 @@ uint8_t uip_acc32[4];
 #if UIP_UDP
 struct uip_udp_conn *uip_udp_conn;
 struct uip_udp_conn uip_udp_conns[UIP_UDP_CONNS];
+
+#if UIP_CONN_HASH_SIZE
+/* The bound UDP connections chained by the hash of their local port, and
+   the list of unused ones. */
+static struct uip_udp_conn *uip_udp_conn_hash[UIP_CONN_HASH_SIZE];
+static struct uip_udp_conn *uip_udp_conn_free;
+#endif /* UIP_CONN_HASH_SIZE */
 #endif /* UIP_UDP */
 /** @} */
 
+#if UIP_CONN_HASH_SIZE
+/* Hash bucket of a local port in network byte order */
+#define UIP_CONN_HASH(port) \
+  ((unsigned)(((uint32_t)(port) * 0x9E3779B1UL) >> 16) % UIP_CONN_HASH_SIZE)
+#endif /* UIP_CONN_HASH_SIZE */
+
 /*---------------------------------------------------------------------------*/
 /**
  * \name ICMPv6 variables
@@ -324,37 +343,169 @@ uip_add32(uint8_t *op32, uint16_t op16)
 #endif /* UIP_ARCH_ADD32 */
 #endif /* UIP_TCP */
 
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_update16(uint16_t chksum, uint16_t from, uint16_t to)
+{
+  uint32_t sum;
+
+  /* HC' = ~(~HC + ~m + m'), RFC 1624 eqn. 3 */
+  sum = (uint16_t)~chksum;
+  sum += (uint16_t)~from;
+  sum += to;
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return ~sum;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_update(uint16_t chksum, const void *from, const void *to,
+                  uint16_t len)
+{
+  const uint8_t *f = from;
+  const uint8_t *t = to;
+  uint32_t sum;
+  uint16_t m;
+  uint16_t n;
+
+  sum = (uint16_t)~chksum;
+  for(; len >= 2; len -= 2, f += 2, t += 2) {
+    memcpy(&m, f, 2);
+    memcpy(&n, t, 2);
+    sum += (uint16_t)~m;
+    sum += n;
+    if(sum & 0x80000000UL) {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  }
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return ~sum;
+}
+
 #if ! UIP_ARCH_CHKSUM
+/*
+ * The checksum is accumulated without carry handling into a wide
+ * accumulator, which is folded once at the end. 64-bit hosts add 32-bit
+ * words, smaller ones 16-bit words, and hosts with SSE2 add 16 bytes at
+ * a time.
+ */
+#if UINTPTR_MAX > 0xffffffffUL
+#define UIP_CHKSUM_ACC64 1
+typedef uint64_t uip_chksum_acc_t;
+#else /* UINTPTR_MAX > 0xffffffffUL */
+#define UIP_CHKSUM_ACC64 0
+typedef uint32_t uip_chksum_acc_t;
+#endif /* UINTPTR_MAX > 0xffffffffUL */
+
+#if defined(__SSE2__) && (!defined(UIP_CONF_CHKSUM_SIMD) || UIP_CONF_CHKSUM_SIMD)
+#define UIP_CHKSUM_SSE2 1
+#include <emmintrin.h>
+#else
+#define UIP_CHKSUM_SSE2 0
+#endif
+/*---------------------------------------------------------------------------*/
+/* Sum the 16-bit words in host byte order of a buffer starting at an even
+   address. A trailing odd byte is taken as a word padded with zero. */
+static uip_chksum_acc_t
+chksum_words(const uint8_t *data, uint16_t len)
+{
+  uip_chksum_acc_t acc = 0;
+
+#if UIP_CHKSUM_SSE2
+  if(len >= 32) {
+    /* Lanes take at most 2 * 4096 words, they cannot overflow. */
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vacc = zero;
+    __m128i v;
+    uint32_t lanes[4];
+
+    while(len >= 16) {
+      v = _mm_loadu_si128((const __m128i *)data);
+      vacc = _mm_add_epi32(vacc, _mm_unpacklo_epi16(v, zero));
+      vacc = _mm_add_epi32(vacc, _mm_unpackhi_epi16(v, zero));
+      data += 16;
+      len -= 16;
+    }
+    _mm_storeu_si128((__m128i *)lanes, vacc);
+    acc += (uip_chksum_acc_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+#endif /* UIP_CHKSUM_SSE2 */
+
+#if UIP_CHKSUM_ACC64
+  if(((uintptr_t)data & 2) && len >= 2) {
+    acc += *(const uint16_t *)data;
+    data += 2;
+    len -= 2;
+  }
+  while(len >= 16) {
+    const uint32_t *w = (const uint32_t *)data;
+    acc += (uip_chksum_acc_t)w[0] + w[1] + w[2] + w[3];
+    data += 16;
+    len -= 16;
+  }
+  while(len >= 4) {
+    acc += *(const uint32_t *)data;
+    data += 4;
+    len -= 4;
+  }
+#else /* UIP_CHKSUM_ACC64 */
+  while(len >= 8) {
+    const uint16_t *w = (const uint16_t *)data;
+    acc += (uip_chksum_acc_t)w[0] + w[1] + w[2] + w[3];
+    data += 8;
+    len -= 8;
+  }
+#endif /* UIP_CHKSUM_ACC64 */
+  while(len >= 2) {
+    acc += *(const uint16_t *)data;
+    data += 2;
+    len -= 2;
+  }
+  if(len == 1) {
+#if UIP_BYTE_ORDER == UIP_LITTLE_ENDIAN
+    acc += data[0];
+#else
+    acc += (uint16_t)data[0] << 8;
+#endif
+  }
+  return acc;
+}
 /*---------------------------------------------------------------------------*/
 static uint16_t
 chksum(uint16_t sum, const uint8_t *data, uint16_t len)
 {
-  uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
+  uip_chksum_acc_t acc;
+  uint16_t lead;
+  uint8_t swap;
+
+  /* The words are summed in host byte order, which has to be swapped on
+     little endian hosts. Starting at an odd address shifts the remaining
+     words by one byte, which toggles the swap. */
+  swap = UIP_BYTE_ORDER == UIP_LITTLE_ENDIAN;
+  lead = 0;
+  if(len > 0 && ((uintptr_t)data & 1)) {
+    lead = (uint16_t)data[0] << 8;
+    data++;
+    len--;
+    swap = !swap;
+  }
 
-  dataptr = data;
-  last_byte = data + len - 1;
-  
-  while(dataptr < last_byte) {   /* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
-    dataptr += 2;
+  acc = chksum_words(data, len);
+  while(acc >> 16) {
+    acc = (acc & 0xffff) + (acc >> 16);
   }
-  
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
+  if(swap) {
+    acc = ((acc & 0xff) << 8) | (acc >> 8);
+  }
+
+  acc += (uip_chksum_acc_t)sum + lead;
+  while(acc >> 16) {
+    acc = (acc & 0xffff) + (acc >> 16);
   }
 
   /* Return sum in host byte order. */
-  return sum;
+  return (uint16_t)acc;
 }
 /*---------------------------------------------------------------------------*/
 uint16_t
@@ -431,6 +582,113 @@ uip_udpchksum(void)
 }
 #endif /* UIP_UDP && UIP_UDP_CHECKSUMS */
 #endif /* UIP_ARCH_CHKSUM */
+#if UIP_CONN_HASH_SIZE
+#if UIP_TCP
+/*---------------------------------------------------------------------------*/
+static void
+tcp_conn_set_lport(struct uip_conn *conn, uint16_t lport)
+{
+  struct uip_conn **p;
+
+  for(p = &uip_conn_hash[UIP_CONN_HASH(conn->lport)];
+      *p != NULL; p = &(*p)->hnext) {
+    if(*p == conn) {
+      *p = conn->hnext;
+      break;
+    }
+  }
+  conn->lport = lport;
+  p = &uip_conn_hash[UIP_CONN_HASH(lport)];
+  conn->hnext = *p;
+  *p = conn;
+}
+/*---------------------------------------------------------------------------*/
+/* Find the open connection an incoming segment belongs to */
+static struct uip_conn *
+tcp_conn_lookup(void)
+{
+  struct uip_conn *conn;
+
+  for(conn = uip_conn_hash[UIP_CONN_HASH(UIP_TCP_BUF->destport)];
+      conn != NULL; conn = conn->hnext) {
+    if(conn->tcpstateflags != UIP_CLOSED &&
+       UIP_TCP_BUF->destport == conn->lport &&
+       UIP_TCP_BUF->srcport == conn->rport &&
+       uip_ipaddr_cmp(&UIP_IP_BUF->srcipaddr, &conn->ripaddr)) {
+      break;
+    }
+  }
+  return conn;
+}
+#endif /* UIP_TCP */
+#if UIP_UDP
+/*---------------------------------------------------------------------------*/
+static struct uip_udp_conn **
+udp_conn_bucket(uint16_t lport)
+{
+  return lport != 0 ? &uip_udp_conn_hash[UIP_CONN_HASH(lport)] : &uip_udp_conn_free;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_udp_set_lport(struct uip_udp_conn *conn, uint16_t lport)
+{
+  struct uip_udp_conn **p;
+
+  for(p = udp_conn_bucket(conn->lport); *p != NULL; p = &(*p)->hnext) {
+    if(*p == conn) {
+      *p = conn->hnext;
+      break;
+    }
+  }
+  conn->lport = lport;
+  p = udp_conn_bucket(lport);
+  conn->hnext = *p;
+  *p = conn;
+}
+/*---------------------------------------------------------------------------*/
+/* Find the connection an incoming datagram is delivered to. Connections
+   bound to the remote port and address take precedence over those bound
+   to either of them, which take precedence over unconnected ones. */
+static struct uip_udp_conn *
+udp_conn_lookup(void)
+{
+  struct uip_udp_conn *conn;
+  struct uip_udp_conn *found;
+  uint8_t score;
+  uint8_t found_score;
+
+  found = NULL;
+  found_score = 0;
+  for(conn = uip_udp_conn_hash[UIP_CONN_HASH(UIP_UDP_BUF->destport)];
+      conn != NULL; conn = conn->hnext) {
+    if(UIP_UDP_BUF->destport != conn->lport) {
+      continue;
+    }
+    score = 0;
+    if(conn->rport != 0) {
+      if(UIP_UDP_BUF->srcport != conn->rport) {
+        continue;
+      }
+      score++;
+    }
+    if(!uip_is_addr_unspecified(&conn->ripaddr)) {
+      if(!uip_ipaddr_cmp(&UIP_IP_BUF->srcipaddr, &conn->ripaddr)) {
+        continue;
+      }
+      score++;
+    }
+    if(found == NULL || score > found_score) {
+      found = conn;
+      found_score = score;
+      if(score == 2) {
+        break;
+      }
+    }
+  }
+  return found;
+}
+#endif /* UIP_UDP */
+#endif /* UIP_CONN_HASH_SIZE */
 /*---------------------------------------------------------------------------*/
 void
 uip_init(void)
@@ -448,6 +706,14 @@ uip_init(void)
   for(c = 0; c < UIP_CONNS; ++c) {
     uip_conns[c].tcpstateflags = UIP_CLOSED;
   }
+#if UIP_CONN_HASH_SIZE
+  memset(uip_conn_hash, 0, sizeof(uip_conn_hash));
+  for(c = 0; c < UIP_CONNS; ++c) {
+    uip_conns[c].lport = 0;
+    uip_conns[c].hnext = uip_conn_hash[UIP_CONN_HASH(0)];
+    uip_conn_hash[UIP_CONN_HASH(0)] = &uip_conns[c];
+  }
+#endif /* UIP_CONN_HASH_SIZE */
 #endif /* UIP_TCP */
 
 #if UIP_ACTIVE_OPEN || UIP_UDP
@@ -455,9 +721,20 @@ uip_init(void)
 #endif /* UIP_ACTIVE_OPEN || UIP_UDP */
 
 #if UIP_UDP
+#if UIP_CONN_HASH_SIZE
+  memset(uip_udp_conn_hash, 0, sizeof(uip_udp_conn_hash));
+  uip_udp_conn_free = NULL;
+  /* Chain the unused connections so that they are handed out in order. */
+  for(c = UIP_UDP_CONNS - 1; c >= 0; --c) {
+    uip_udp_conns[c].lport = 0;
+    uip_udp_conns[c].hnext = uip_udp_conn_free;
+    uip_udp_conn_free = &uip_udp_conns[c];
+  }
+#else /* UIP_CONN_HASH_SIZE */
   for(c = 0; c < UIP_UDP_CONNS; ++c) {
     uip_udp_conns[c].lport = 0;
   }
+#endif /* UIP_CONN_HASH_SIZE */
 #endif /* UIP_UDP */
 
 #if UIP_IPV6_MULTICAST
@@ -482,8 +759,13 @@ uip_connect(const uip_ipaddr_t *ripaddr, uint16_t rport)
 
   /* Check if this port is already in use, and if so try to find
      another one. */
+#if UIP_CONN_HASH_SIZE
+  for(conn = uip_conn_hash[UIP_CONN_HASH(uip_htons(lastport))];
+      conn != NULL; conn = conn->hnext) {
+#else /* UIP_CONN_HASH_SIZE */
   for(c = 0; c < UIP_CONNS; ++c) {
     conn = &uip_conns[c];
+#endif /* UIP_CONN_HASH_SIZE */
     if(conn->tcpstateflags != UIP_CLOSED &&
        conn->lport == uip_htons(lastport)) {
       goto again;
@@ -529,7 +811,11 @@ uip_connect(const uip_ipaddr_t *ripaddr, uint16_t rport)
   conn->rto = UIP_RTO;
   conn->sa = 0;
   conn->sv = 16;   /* Initial value of the RTT variance. */
+#if UIP_CONN_HASH_SIZE
+  tcp_conn_set_lport(conn, uip_htons(lastport));
+#else /* UIP_CONN_HASH_SIZE */
   conn->lport = uip_htons(lastport);
+#endif /* UIP_CONN_HASH_SIZE */
   conn->rport = rport;
   uip_ipaddr_copy(&conn->ripaddr, ripaddr);
   
@@ -565,7 +851,9 @@ remove_ext_hdr(void)
 struct uip_udp_conn *
 uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport)
 {
+#if !UIP_CONN_HASH_SIZE
   int c;
+#endif /* !UIP_CONN_HASH_SIZE */
   register struct uip_udp_conn *conn;
   
   /* Find an unused local port. */
@@ -576,6 +864,21 @@ uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport)
     lastport = 4096;
   }
   
+#if UIP_CONN_HASH_SIZE
+  for(conn = uip_udp_conn_hash[UIP_CONN_HASH(uip_htons(lastport))];
+      conn != NULL; conn = conn->hnext) {
+    if(conn->lport == uip_htons(lastport)) {
+      goto again;
+    }
+  }
+
+  conn = uip_udp_conn_free;
+  if(conn == 0) {
+    return 0;
+  }
+
+  uip_udp_set_lport(conn, UIP_HTONS(lastport));
+#else /* UIP_CONN_HASH_SIZE */
   for(c = 0; c < UIP_UDP_CONNS; ++c) {
     if(uip_udp_conns[c].lport == uip_htons(lastport)) {
       goto again;
@@ -595,6 +898,7 @@ uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport)
   }
   
   conn->lport = UIP_HTONS(lastport);
+#endif /* UIP_CONN_HASH_SIZE */
   conn->rport = rport;
   if(ripaddr == NULL) {
     memset(&conn->ripaddr, 0, sizeof(uip_ipaddr_t));
@@ -1515,6 +1819,12 @@ uip_process(uint8_t flag)
   }
 
   /* Demultiplex this UDP packet between the UDP "connections". */
+#if UIP_CONN_HASH_SIZE
+  uip_udp_conn = udp_conn_lookup();
+  if(uip_udp_conn != NULL) {
+    goto udp_found;
+  }
+#else /* UIP_CONN_HASH_SIZE */
   for(uip_udp_conn = &uip_udp_conns[0];
       uip_udp_conn < &uip_udp_conns[UIP_UDP_CONNS];
       ++uip_udp_conn) {
@@ -1534,6 +1844,7 @@ uip_process(uint8_t flag)
       goto udp_found;
     }
   }
+#endif /* UIP_CONN_HASH_SIZE */
   PRINTF("udp: no matching connection found\n\r");
   UIP_STAT(++uip_stat.udp.drop);
 
@@ -1621,6 +1932,12 @@ uip_process(uint8_t flag)
 
   /* Demultiplex this segment. */
   /* First check any active connections. */
+#if UIP_CONN_HASH_SIZE
+  uip_connr = tcp_conn_lookup();
+  if(uip_connr != NULL) {
+    goto found;
+  }
+#else /* UIP_CONN_HASH_SIZE */
   for(uip_connr = &uip_conns[0]; uip_connr <= &uip_conns[UIP_CONNS - 1];
       ++uip_connr) {
     if(uip_connr->tcpstateflags != UIP_CLOSED &&
@@ -1630,6 +1947,7 @@ uip_process(uint8_t flag)
       goto found;
     }
   }
+#endif /* UIP_CONN_HASH_SIZE */
 
   /* If we didn't find and active connection that expected the packet,
      either this packet is an old duplicate, or this is a SYN packet
@@ -1742,7 +2060,11 @@ uip_process(uint8_t flag)
   uip_connr->sa = 0;
   uip_connr->sv = 4;
   uip_connr->nrtx = 0;
+#if UIP_CONN_HASH_SIZE
+  tcp_conn_set_lport(uip_connr, UIP_TCP_BUF->destport);
+#else /* UIP_CONN_HASH_SIZE */
   uip_connr->lport = UIP_TCP_BUF->destport;
+#endif /* UIP_CONN_HASH_SIZE */
   uip_connr->rport = UIP_TCP_BUF->srcport;
   uip_ipaddr_copy(&uip_connr->ripaddr, &UIP_IP_BUF->srcipaddr);
   uip_connr->tcpstateflags = UIP_SYN_RCVD;
@@ -41,7 +41,9 @@
 
 void _udp_sock_callback(c_event_t c_event, p_data_t p_data);
 
+#if (UDP_SOCKET_ZERO_COPY != TRUE)
 static uint8_t buf[UIP_BUFSIZE];
+#endif /* #if (UDP_SOCKET_ZERO_COPY != TRUE) */
 
 #define UIP_IP_BUF   ((struct uip_udpip_hdr *)&uip_buf[UIP_LLH_LEN])
 
@@ -173,10 +175,16 @@ void _udp_sock_callback(c_event_t c_event, p_data_t p_data)
             /* If we were called because of incoming data, we should call
                the reception callback. */
             if(uip_newdata()) {
+#if (UDP_SOCKET_ZERO_COPY == TRUE)
+                /* Hand the payload over in place, the callee must not
+                   use it after sending. */
+                const uint8_t *buf = uip_appdata;
+#else
                 /* Copy the data from the uIP data buffer into our own
                    buffer to avoid the uIP buffer being messed with by the
                    callee. */
                 memcpy(buf, uip_appdata, uip_datalen());
+#endif /* #if (UDP_SOCKET_ZERO_COPY == TRUE) */
 
                 /* Call the client process. We use the PROCESS_CONTEXT
                    mechanism to temporarily switch process context to the
@@ -671,5 +671,45 @@ int8_t bsp_sleepEnter( uint32_t duration );
 int8_t bsp_adjustTick( clock_time_t ticks );
 #endif /* #if (HAL_SUPPORT_MCU_SLEEP == TRUE) */
 
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+/**
+ * bsp_ioRegister()
+ *
+ * \brief   Register a descriptor the main loop shall wake up on.
+ *
+ * \param   fd      Descriptor to watch.
+ * \param   pf_cb   Callback function invoked when fd is readable.
+ * \param   p_data  Data pointer passed to the callback.
+ *
+ * \return  0 on success or negative value on error.
+ */
+int8_t bsp_ioRegister( int32_t fd, pf_hal_irqCb_t pf_cb, void* p_data );
+
+
+/**
+ * bsp_ioUnregister()
+ *
+ * \brief   Remove a descriptor previously added by bsp_ioRegister().
+ *
+ * \param   fd      Descriptor to remove.
+ *
+ * \return  0 on success or negative value on error.
+ */
+int8_t bsp_ioUnregister( int32_t fd );
+
+
+/**
+ * bsp_waitEvent()
+ *
+ * \brief   Block until a registered input arrives or the timeout elapses.
+ *
+ * \param   us_timeout  Timeout in microseconds. A negative value waits
+ *                      forever, 0 only polls the inputs.
+ *
+ * \return  0 on success or negative value on error.
+ */
+int8_t bsp_waitEvent( int32_t us_timeout );
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
+
 #endif /* __BSP_H__ */
 
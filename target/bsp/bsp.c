@@ -783,3 +783,33 @@ int8_t bsp_adjustTick( clock_time_t ticks )
   return hal_adjustTick(ticks);
 } /* bsp_adjustTick */
 #endif /* #if (HAL_SUPPORT_MCU_SLEEP == TRUE) */
+
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+/*---------------------------------------------------------------------------*/
+/*
+* bsp_ioRegister()
+*/
+int8_t bsp_ioRegister( int32_t fd, pf_hal_irqCb_t pf_cb, void* p_data )
+{
+  EMB6_ASSERT_RET( pf_cb != NULL, -1 );
+  return hal_ioRegister( fd, pf_cb, p_data );
+} /* bsp_ioRegister() */
+
+/*---------------------------------------------------------------------------*/
+/*
+* bsp_ioUnregister()
+*/
+int8_t bsp_ioUnregister( int32_t fd )
+{
+  return hal_ioUnregister( fd );
+} /* bsp_ioUnregister() */
+
+/*---------------------------------------------------------------------------*/
+/*
+* bsp_waitEvent()
+*/
+int8_t bsp_waitEvent( int32_t us_timeout )
+{
+  return hal_waitEvent( us_timeout );
+} /* bsp_waitEvent() */
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
@@ -88,7 +88,11 @@ int8_t board_conf( s_ns_t* p_ns )
   p_ns->dllc = &dllc_driver_802154;
   p_ns->mac  = &mac_driver_null;
   p_ns->phy  = &phy_driver_null;
+#if (NATIVE_CONF_RF_SHM == TRUE)
+  p_ns->rf   = &rf_driver_native_shm;
+#else
   p_ns->rf   = &rf_driver_native;
+#endif /* #if (NATIVE_CONF_RF_SHM == TRUE) */
   etimer_init();
 
   return 0;
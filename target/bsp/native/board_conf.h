@@ -72,6 +72,31 @@
 #define HAL_SUPPORT_LEDNUM                    ( 0 )
 #endif /* #ifndef HAL_SUPPORT_LEDNUM */
 
+/** Exchange frames through shared memory instead of LCM */
+#ifndef NATIVE_CONF_RF_SHM
+#define NATIVE_CONF_RF_SHM                    FALSE
+#endif /* #ifndef NATIVE_CONF_RF_SHM */
+
+/** Run on a simulation clock instead of the wall clock (see linux.c) */
+#ifndef NATIVE_CONF_VIRTUAL_TIME
+#define NATIVE_CONF_VIRTUAL_TIME              FALSE
+#endif /* #ifndef NATIVE_CONF_VIRTUAL_TIME */
+
+#if (NATIVE_CONF_VIRTUAL_TIME == TRUE) && (NATIVE_CONF_RF_SHM == TRUE)
+#error "The simulation clock is limited to a single node and can not share a medium"
+#endif
+
+/** Block the main loop on I/O and timers instead of polling with the delay
+ * given to emb6_process(). The shared memory radio and the simulation clock
+ * depend on it. */
+#ifndef HAL_SUPPORT_EVENTWAIT
+#if (NATIVE_CONF_RF_SHM == TRUE) || (NATIVE_CONF_VIRTUAL_TIME == TRUE)
+#define HAL_SUPPORT_EVENTWAIT                 TRUE
+#else
+#define HAL_SUPPORT_EVENTWAIT                 FALSE
+#endif /* #if (NATIVE_CONF_RF_SHM == TRUE) || (NATIVE_CONF_VIRTUAL_TIME == TRUE) */
+#endif /* #ifndef HAL_SUPPORT_EVENTWAIT */
+
 
 /*
  * --- Stack Macro Definitions ---------------------------------------------- *
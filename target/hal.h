@@ -854,4 +854,50 @@ int8_t hal_sleepEnter( uint32_t duration );
  */
 int8_t hal_adjustTick( uint32_t ticks );
 #endif /* #if (HAL_SUPPORT_MCU_SLEEP == TRUE) */
+
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+/**
+ * hal_ioRegister()
+ *
+ * \brief   Register a descriptor the main loop shall wake up on.
+ *
+ *          Platforms hosted by an operating system can block the main loop
+ *          until either an input becomes readable or a timer expires. The
+ *          callback is invoked from within hal_waitEvent() as soon as the
+ *          descriptor is readable.
+ *
+ * \param   fd      Descriptor to watch.
+ * \param   pf_cb   Callback function invoked when fd is readable.
+ * \param   p_data  Data pointer passed to the callback.
+ *
+ * \return  0 on success or negative value on error.
+ */
+int8_t hal_ioRegister( int32_t fd, pf_hal_irqCb_t pf_cb, void* p_data );
+
+
+/**
+ * hal_ioUnregister()
+ *
+ * \brief   Remove a descriptor previously added by hal_ioRegister().
+ *
+ * \param   fd      Descriptor to remove.
+ *
+ * \return  0 on success or negative value on error.
+ */
+int8_t hal_ioUnregister( int32_t fd );
+
+
+/**
+ * hal_waitEvent()
+ *
+ * \brief   Block until a registered input or a signal arrives or the
+ *          timeout elapses.
+ *
+ * \param   us_timeout  Timeout in microseconds. A negative value waits
+ *                      forever, 0 only polls the inputs.
+ *
+ * \return  0 on success or negative value on error.
+ */
+int8_t hal_waitEvent( int32_t us_timeout );
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
 #endif /* __HAL_H__ */
@@ -61,6 +61,7 @@
 #include "packetbuf.h"
 #include "tcpip.h"
 #include "etimer.h"
+#include "memb.h"
 #include <errno.h>
 #include <sys/time.h>
 #include <stdio.h>
@@ -82,14 +83,90 @@
 #define LCM_NETWORK_CONF                  "lcmnetwork.conf"
 #endif /*#ifndef LCM_NETWORK_CONF */
 
+/** Number of received frames buffered until the stack consumes them */
+#ifdef NATIVE_CONF_RXQ_SIZE
+#define NATIVE_RXQ_SIZE                   NATIVE_CONF_RXQ_SIZE
+#else
+#define NATIVE_RXQ_SIZE                   16
+#endif /* #ifdef NATIVE_CONF_RXQ_SIZE */
+
+/** Emulate lossy links. Frames then carry the address of their sender,
+ *  so all nodes of an emulated network must enable the model. */
+#ifndef NATIVE_CONF_LINK_MODEL
+#define NATIVE_CONF_LINK_MODEL            FALSE
+#endif /* #ifndef NATIVE_CONF_LINK_MODEL */
+
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+/** Number of links that can be configured */
+#ifdef NATIVE_CONF_LINKS
+#define NATIVE_LINKS                      NATIVE_CONF_LINKS
+#else
+#define NATIVE_LINKS                      32
+#endif /* #ifdef NATIVE_CONF_LINKS */
+
+/** Bit rate used to compute the air time of a frame */
+#ifdef NATIVE_CONF_BITRATE
+#define NATIVE_BITRATE                    NATIVE_CONF_BITRATE
+#else
+#define NATIVE_BITRATE                    50000UL
+#endif /* #ifdef NATIVE_CONF_BITRATE */
+
+/** Length of the header that carries the sender address */
+#define NATIVE_LINK_HDR_LEN               2
+
+/** Address matching all senders */
+#define NATIVE_LINK_ANY                   0xFFFFU
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
+
 /*==============================================================================
                                      ENUMS
  ==============================================================================*/
 
+/*==============================================================================
+                             STRUCTURES AND OTHER TYPEDEFS
+ ==============================================================================*/
+/** Received frame waiting for the stack */
+typedef struct
+{
+    uint16_t i_len;
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+    /** Time the frame has been received completely */
+    uint32_t l_dueUs;
+    int8_t c_rssi;
+    uint8_t c_lqi;
+    /** Destroyed by an overlapping frame */
+    uint8_t c_collided;
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
+    uint8_t pc_data[PACKETBUF_SIZE];
+} s_nativeRxFrame_t;
+
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+/** Model of the link from a sender to this node */
+typedef struct
+{
+    /** Short address of the sender, NATIVE_LINK_ANY for all senders */
+    uint16_t i_src;
+    /** Packet error rate in per mille */
+    uint16_t i_per;
+    /** Frame length the packet error rate refers to, 0 if it does not
+     *  depend on the length */
+    uint16_t i_perLen;
+    /** Propagation and queueing delay */
+    uint32_t l_delayUs;
+    int8_t c_rssi;
+    uint8_t c_lqi;
+} s_nativeLink_t;
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
+
 /*==============================================================================
                              VARIABLE DECLARATIONS
  ==============================================================================*/
+#if (HAL_SUPPORT_EVENTWAIT != TRUE)
 static struct etimer ps_nativeTmr;
+#else
+/* Timer retrying a failed post of the RX event */
+static struct etimer s_retryTmr;
+#endif /* #if (HAL_SUPPORT_EVENTWAIT != TRUE) */
 /* Pointer to the lmac structure */
 static const s_nsPHY_t* p_phy = NULL;
 extern uip_lladdr_t uip_lladdr;
@@ -97,6 +174,27 @@ static lcm_t *ps_lcm;
 static char pc_publish_ch[NODE_INFO_MAX];
 static char *pc_subscribe_ch;
 static lcm_subscription_t *subscr;
+/* Ring of received frames */
+static s_nativeRxFrame_t ps_rxq[NATIVE_RXQ_SIZE];
+static uint16_t i_rxqHead;
+static uint16_t i_rxqCnt;
+/* An event handing the queued frames to the PHY is pending */
+static uint8_t c_rxqPosted;
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+/* Configured links, the first one applies to unknown senders */
+static s_nativeLink_t ps_links[NATIVE_LINKS] = {
+        { NATIVE_LINK_ANY, 0, 0, 0, -40, 255 } };
+static uint16_t i_linkCnt = 1;
+/* Model collisions of overlapping frames */
+static uint8_t c_collisions;
+/* End of the air time of the last queued frame */
+static uint32_t l_lastEndUs;
+/* Link quality of the frame handed to the PHY */
+static int8_t c_lastRssi;
+static uint8_t c_lastLqi;
+/* Timer delaying the delivery of a frame */
+static struct etimer s_delayTmr;
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
 /*==============================================================================
                                  GLOBAL CONSTANTS
  ==============================================================================*/
@@ -116,7 +214,21 @@ static void _native_ioctl(e_nsIocCmd_t cmd, void *p_val, e_nsErr_t *p_err);
 
 static void _native_read( const lcm_recv_buf_t *rbuf, const char * channel,
         void * p_macAddr );
+static void _native_drain( void );
+static void _native_rxPost( uint8_t c_cont );
+static void _native_rxHandler( c_event_t c_event, p_data_t p_data );
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+static uint32_t _native_timeUs( void );
+static s_nativeLink_t* _native_linkGet( uint16_t i_src, uint8_t c_add );
+static void _native_linkCmd( const char *line );
+static void _native_delayHandler( c_event_t c_event, p_data_t p_data );
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+static void _native_ioHandler( void* p_data );
+static void _native_retryHandler( c_event_t c_event, p_data_t p_data );
+#else
 static void _native_handler( c_event_t c_event, p_data_t p_data );
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
 static void _beautiful_split_messages( const lcm_recv_buf_t *rps_rbuf,
         const char * rpc_channel, void * userdata );
 static void _beautiful_comand_parser( const char *line);
@@ -257,6 +369,14 @@ static void _native_init( void *p_netstk, e_nsErr_t *p_err )
     /* Close the file */
     fclose(fp);
 
+#if (NATIVE_CONF_VIRTUAL_TIME == TRUE)
+    /* the simulation clock is not synchronized with other nodes */
+    if( pc_publish_ch[0] != '\0' )
+    {
+        _printAndExit( "The simulation clock does not support neighbours" );
+    }
+#endif /* #if (NATIVE_CONF_VIRTUAL_TIME == TRUE) */
+
     LOG1_OK( "Native driver init" );
 
     /* Mac address should not be NULL pointer, although it can't be, but still
@@ -287,7 +407,18 @@ static void _native_init( void *p_netstk, e_nsErr_t *p_err )
     }
 
     /* Start the packet receive process */
+    i_rxqHead = 0;
+    i_rxqCnt = 0;
+    evproc_regCallback( EVENT_TYPE_PCK_LL, _native_rxHandler );
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+    bsp_ioUnregister( lcm_get_fileno( ps_lcm ) );
+    if( bsp_ioRegister( lcm_get_fileno( ps_lcm ), _native_ioHandler, ps_lcm ) != 0 )
+    {
+        _printAndExit( "Error on registering the LCM descriptor" );
+    }
+#else
     etimer_set( &ps_nativeTmr, 10, _native_handler );
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
 
     return;
 } /* _native_init() */
@@ -312,7 +443,25 @@ static void _native_send( uint8_t *p_data, uint16_t len, e_nsErr_t *p_err )
 #endif
 
     *p_err = NETSTK_ERR_NONE;
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+    {
+        /* tell the receivers which link the frame takes */
+        uint8_t pc_frame[NATIVE_LINK_HDR_LEN + PACKETBUF_SIZE];
+
+        if( len > PACKETBUF_SIZE )
+        {
+            *p_err = NETSTK_ERR_BUF_OVERFLOW;
+            return;
+        }
+        pc_frame[0] = mac_phy_config.mac_address[6];
+        pc_frame[1] = mac_phy_config.mac_address[7];
+        memcpy( &pc_frame[NATIVE_LINK_HDR_LEN], p_data, len );
+        status = lcm_publish( ps_lcm, pc_publish_ch, pc_frame,
+                NATIVE_LINK_HDR_LEN + len );
+    }
+#else
     status = lcm_publish( ps_lcm, pc_publish_ch, p_data, len );
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
 
     /* Return execution status to a caller */
     if( status == -1 )
@@ -348,7 +497,36 @@ static void _native_ioctl(e_nsIocCmd_t cmd, void *p_val, e_nsErr_t *p_err)
 #endif
 
     *p_err = NETSTK_ERR_NONE;
-} /* _native_on() */
+    switch( cmd )
+    {
+        case NETSTK_CMD_RF_TXPOWER_SET:
+        case NETSTK_CMD_RF_CHAN_NUM_SET:
+        case NETSTK_CMD_RF_OP_MODE_SET:
+        case NETSTK_CMD_RF_WOR_EN:
+            /* accepted, the simulated medium has a single channel */
+            break;
+
+        case NETSTK_CMD_RF_CCA_GET:
+        case NETSTK_CMD_RF_IS_RX_BUSY:
+            /* the channel is clear and frames arrive in one piece */
+            break;
+
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+        case NETSTK_CMD_RF_RSSI_GET:
+            *((int8_t *)p_val) = c_lastRssi;
+            break;
+
+        case NETSTK_CMD_RF_LQI_GET:
+            *((uint8_t *)p_val) = c_lastLqi;
+            break;
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
+
+        default:
+            /* unsupported commands are treated in same way */
+            *p_err = NETSTK_ERR_CMD_UNSUPPORTED;
+            break;
+    }
+} /* _native_ioctl() */
 
 /*----------------------------------------------------------------------------*/
 /** \brief  NATIVE transport message reception
@@ -364,31 +542,338 @@ static void _native_read( const lcm_recv_buf_t *rps_rbuf,
         const char * rpc_channel, void * userdata )
 {
     uint16_t i_dSize = rps_rbuf->data_size;
-    e_nsErr_t s_err = NETSTK_ERR_NONE;
+    const uint8_t *pc_data = rps_rbuf->data;
+    s_nativeRxFrame_t *ps_frame;
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+    s_nativeLink_t *ps_link;
+    uint32_t l_per;
+    uint32_t l_startUs;
+    uint32_t l_endUs;
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
 
-    /* Clear buffer where to store received payload */
-    packetbuf_clear();
+#if (NATIVE_CONF_VIRTUAL_TIME == TRUE)
+    /* another node shares the medium, e.g. it lists this node as its
+     * neighbour, its clock is not synchronized with the simulation clock */
+    _printAndExit( "The simulation clock does not support other nodes" );
+#endif /* #if (NATIVE_CONF_VIRTUAL_TIME == TRUE) */
+
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+    if( i_dSize < NATIVE_LINK_HDR_LEN )
+    {
+        LOG_ERR( "Failed to receive packet" );
+        return;
+    }
+    ps_link = _native_linkGet( ((uint16_t)pc_data[0] << 8) | pc_data[1],
+            FALSE );
+    pc_data += NATIVE_LINK_HDR_LEN;
+    i_dSize -= NATIVE_LINK_HDR_LEN;
+
+    /* packet error, scaled with the length if requested */
+    l_per = ps_link->i_per;
+    if( ps_link->i_perLen != 0 )
+    {
+        l_per = (l_per * i_dSize) / ps_link->i_perLen;
+    }
+    if( (l_per > 0) && (bsp_getrand( 0, 999 ) < l_per) )
+    {
+        LOG_INFO( "RX packet [%d] lost on link", i_dSize );
+        return;
+    }
+
+    /* frames overlapping on the air destroy each other */
+    l_startUs = _native_timeUs() + ps_link->l_delayUs;
+    l_endUs = l_startUs + (uint32_t)((uint64_t)i_dSize * 8 * 1000000UL /
+            NATIVE_BITRATE);
+    if( (c_collisions == TRUE) && (i_rxqCnt > 0) &&
+        ((int32_t)(l_startUs - l_lastEndUs) < 0) )
+    {
+        LOG_INFO( "RX packet [%d] collided", i_dSize );
+        ps_rxq[(i_rxqHead + i_rxqCnt - 1) % NATIVE_RXQ_SIZE].c_collided = TRUE;
+        return;
+    }
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
 
     /* Check whether recieved packet is not too long */
     if( i_dSize > PACKETBUF_SIZE )
     {
         LOG_ERR( "Received packet too long" );
     }
+    else if( i_dSize == 0 )
+    {
+        LOG_ERR( "Failed to receive packet" );
+    }
+    else if( i_rxqCnt == NATIVE_RXQ_SIZE )
+    {
+        LOG_ERR( "RX queue full, packet dropped" );
+    }
     else
     {
         LOG_OK( "RX packet [%d]", i_dSize);
-        LOG2_HEXDUMP( rps_rbuf->data, i_dSize  );
-        if( ( rps_rbuf->data_size > 0 ) && ( p_phy != NULL ) )
+        LOG2_HEXDUMP( pc_data, i_dSize  );
+
+        /* Queue the frame, the stack takes it from the event handler */
+        ps_frame = &ps_rxq[(i_rxqHead + i_rxqCnt) % NATIVE_RXQ_SIZE];
+        memcpy( ps_frame->pc_data, pc_data, i_dSize );
+        ps_frame->i_len = i_dSize;
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+        ps_frame->l_dueUs = l_endUs;
+        ps_frame->c_rssi = ps_link->c_rssi;
+        ps_frame->c_lqi = ps_link->c_lqi;
+        ps_frame->c_collided = FALSE;
+        l_lastEndUs = l_endUs;
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
+        i_rxqCnt++;
+    }
+
+    /* also retries a post that failed before */
+    _native_rxPost( FALSE );
+} /* _native_read() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Post the event handing the queued frames to the PHY, unless one
+ *          is pending already. A failed post is retried on the next read or
+ *          timer tick, otherwise the queue would never be drained again.
+ *  \param  c_cont        TRUE to post the continuation of a drain
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_rxPost( uint8_t c_cont )
+{
+    en_evprocResCode_t e_res;
+
+    if( (c_rxqPosted == TRUE) || (i_rxqCnt == 0) )
+    {
+        return;
+    }
+
+    if( c_cont == TRUE )
+    {
+        e_res = evproc_putTargetEvent( E_EVPROC_TAIL, EVENT_TYPE_PCK_INPUT,
+                ps_rxq, _native_rxHandler );
+    }
+    else
+    {
+        e_res = evproc_putEvent( E_EVPROC_TAIL, EVENT_TYPE_PCK_LL, ps_rxq );
+    }
+
+    if( e_res == E_SUCCESS )
+    {
+        c_rxqPosted = TRUE;
+    }
+    else
+    {
+        LOG_ERR( "Failed to post RX event, retrying" );
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+        etimer_set( &s_retryTmr, 1, _native_retryHandler );
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
+    }
+} /* _native_rxPost() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Hand the oldest received frame to the PHY. The first frame is
+ *          signaled with EVENT_TYPE_PCK_LL of the high priority class. The
+ *          remaining frames are handed over one per EVENT_TYPE_PCK_INPUT
+ *          event of the normal class, so that timer and stack events queued
+ *          meanwhile are served in between.
+ *  \param  c_event       Source of an event.
+ *  \param  p_data        Pointer to the RX queue
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_rxHandler( c_event_t c_event, p_data_t p_data )
+{
+    e_nsErr_t s_err = NETSTK_ERR_NONE;
+    s_nativeRxFrame_t *ps_frame;
+
+    if( ((c_event != EVENT_TYPE_PCK_LL) && (c_event != EVENT_TYPE_PCK_INPUT)) ||
+        (p_data != ps_rxq) )
+    {
+        return;
+    }
+
+    c_rxqPosted = FALSE;
+    if( i_rxqCnt == 0 )
+    {
+        return;
+    }
+
+    ps_frame = &ps_rxq[i_rxqHead];
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+    {
+        int32_t l_waitUs = (int32_t)(ps_frame->l_dueUs - _native_timeUs());
+        if( l_waitUs > 0 )
         {
-            packetbuf_set_datalen( i_dSize );
-            p_phy->recv( rps_rbuf->data, i_dSize, &s_err );
+            /* not on the air completely yet, the timer posts the event
+             * again, a read meanwhile just restarts it */
+            etimer_set( &s_delayTmr, 1 + ((clock_time_t)l_waitUs *
+                    bsp_getTRes()) / 1000000UL, _native_delayHandler );
+            return;
+        }
+    }
+    c_lastRssi = ps_frame->c_rssi;
+    c_lastLqi = ps_frame->c_lqi;
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
+    i_rxqHead = (i_rxqHead + 1) % NATIVE_RXQ_SIZE;
+    i_rxqCnt--;
+    _native_rxPost( TRUE );
+
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+    if( ps_frame->c_collided == TRUE )
+    {
+        return;
+    }
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
+
+    /* The slot is only reused by the next drain, after the stack is done */
+    packetbuf_clear();
+    packetbuf_set_datalen( ps_frame->i_len );
+    if( p_phy != NULL )
+    {
+        p_phy->recv( ps_frame->pc_data, ps_frame->i_len, &s_err );
+    }
+} /* _native_rxHandler() */
+
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+/*----------------------------------------------------------------------------*/
+/** \brief  Get the time of the node in microseconds, it follows the
+ *          simulation clock if there is one.
+ *  \return Time in microseconds, wrapping around
+ */
+/*----------------------------------------------------------------------------*/
+static uint32_t _native_timeUs( void )
+{
+    return (uint32_t)(((uint64_t)bsp_getTick() * 1000000UL) / bsp_getTRes());
+} /* _native_timeUs() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Delivery of a delayed frame is due
+ *  \param  c_event       Source of an event.
+ *  \param  p_data        Pointer to the expired timer
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_delayHandler( c_event_t c_event, p_data_t p_data )
+{
+    if( p_data == &s_delayTmr )
+    {
+        _native_rxPost( FALSE );
+    }
+} /* _native_delayHandler() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Find the model of the link from a sender
+ *  \param  i_src         Short address of the sender
+ *  \param  c_add         Add the link if it is not configured yet
+ *  \return The link, the default link if it is not found and not added
+ */
+/*----------------------------------------------------------------------------*/
+static s_nativeLink_t* _native_linkGet( uint16_t i_src, uint8_t c_add )
+{
+    uint16_t i;
+
+    for( i = 0; i < i_linkCnt; i++ )
+    {
+        if( ps_links[i].i_src == i_src )
+        {
+            return &ps_links[i];
+        }
+    }
+    if( (c_add == TRUE) && (i_linkCnt < NATIVE_LINKS) )
+    {
+        /* start from the default link */
+        ps_links[i_linkCnt] = ps_links[0];
+        ps_links[i_linkCnt].i_src = i_src;
+        return &ps_links[i_linkCnt++];
+    }
+    return &ps_links[0];
+} /* _native_linkGet() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Configure the link model. The commands are
+ *          "link <src|any> <per> [<perLen> [<delayUs> [<rssi> [<lqi>]]]]"
+ *          with the packet error rate in per mille, "link reset" and
+ *          "collision <0|1>".
+ *  \param  line          Command line
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_linkCmd( const char *line )
+{
+    char pc_src[8];
+    unsigned int i_src, i_per, i_perLen, i_lqi;
+    unsigned long l_delayUs;
+    int l_rssi, l_args, l_on;
+    s_nativeLink_t *ps_link;
+
+    if( strncmp( line, "link reset", 10 ) == 0 )
+    {
+        i_linkCnt = 1;
+        ps_links[0].i_per = 0;
+        ps_links[0].i_perLen = 0;
+        ps_links[0].l_delayUs = 0;
+        ps_links[0].c_rssi = -40;
+        ps_links[0].c_lqi = 255;
+    }
+    else if( strncmp( line, "link", 4 ) == 0 )
+    {
+        l_args = sscanf( line + 4, "%7s %u %u %lu %d %u", pc_src, &i_per,
+                &i_perLen, &l_delayUs, &l_rssi, &i_lqi );
+        if( l_args < 2 )
+        {
+            LOG_ERR( "Invalid link command" );
+            return;
+        }
+        if( strcmp( pc_src, "any" ) == 0 )
+        {
+            ps_link = &ps_links[0];
+        }
+        else if( sscanf( pc_src, "%x", &i_src ) == 1 )
+        {
+            ps_link = _native_linkGet( (uint16_t)i_src, TRUE );
         }
         else
         {
-            LOG_ERR( "Failed to receive packet" );
+            LOG_ERR( "Invalid link command" );
+            return;
         }
+        ps_link->i_per = (i_per > 1000) ? 1000 : i_per;
+        if( l_args > 2 ) ps_link->i_perLen = i_perLen;
+        if( l_args > 3 ) ps_link->l_delayUs = l_delayUs;
+        if( l_args > 4 ) ps_link->c_rssi = (int8_t)l_rssi;
+        if( l_args > 5 ) ps_link->c_lqi = (uint8_t)i_lqi;
     }
-} /* _native_read() */
+    else if( (strncmp( line, "collision", 9 ) == 0) &&
+             (sscanf( line + 9, "%d", &l_on ) == 1) )
+    {
+        c_collisions = (l_on != 0) ? TRUE : FALSE;
+    }
+} /* _native_linkCmd() */
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Read all messages pending on the LCM descriptor, as long as
+ *          the RX queue has room for them.
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_drain( void )
+{
+    int32_t lcm_fd = lcm_get_fileno( ps_lcm );
+    struct timeval s_tv;
+    fd_set fds;
+
+    do
+    {
+        /* the descriptor is readable, lcm_handle() won't block */
+        lcm_handle( ps_lcm );
+
+        FD_ZERO( &fds );
+        FD_SET( lcm_fd, &fds );
+        s_tv.tv_sec = 0;
+        s_tv.tv_usec = 0;
+    } while( (i_rxqCnt < NATIVE_RXQ_SIZE) &&
+             (select( lcm_fd + 1, &fds, 0, 0, &s_tv ) > 0) );
+} /* _native_drain() */
 
 /*----------------------------------------------------------------------------*/
 /** \brief  NATIVE transport wrapper function
@@ -423,6 +908,44 @@ static void _native_off( e_nsErr_t *p_err )
     *p_err = NETSTK_ERR_NONE;
 } /* _native_off() */
 
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE transport handler called by the main loop as soon as
+ *          the LCM descriptor is readable, lcm_handle() won't block then.
+ *  \param  p_data        Pointer to the LCM instance
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_ioHandler( void* p_data )
+{
+    /* A full queue leaves the remaining messages pending, the descriptor
+     * then stays readable and the main loop comes back once the stack
+     * has consumed the queued frames. */
+    if( i_rxqCnt < NATIVE_RXQ_SIZE )
+    {
+        _native_drain();
+    }
+    else
+    {
+        _native_rxPost( FALSE );
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Retry to post the RX event
+ *  \param  c_event       Source of an event.
+ *  \param  p_data        Pointer to the expired timer
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_retryHandler( c_event_t c_event, p_data_t p_data )
+{
+    if( p_data == &s_retryTmr )
+    {
+        _native_rxPost( FALSE );
+    }
+} /* _native_retryHandler() */
+#else
 /*----------------------------------------------------------------------------*/
 /** \brief  NATIVE transport handler for periodic polling
  *          triggered every 10 msec
@@ -453,15 +976,19 @@ static void _native_handler( c_event_t c_event, p_data_t p_data )
         /* If descriptor is available for reading then there is a incoming data
          * to read.
          */
-        if( FD_ISSET( lcm_fd, &fds ) )
+        if( FD_ISSET( lcm_fd, &fds ) && (i_rxqCnt < NATIVE_RXQ_SIZE) )
         {
-            lcm_handle( ps_lcm );
+            _native_drain();
         }
+        /* retry a post of the RX event that failed */
+        _native_rxPost( FALSE );
+
         /* Restart a timer anyway. */
         etimer_restart( &ps_nativeTmr );
 
     }
 }
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
 
 /*----------------------------------------------------------------------------*/
 /** \brief  "BEAUTIFUL" split messages reception
@@ -530,6 +1057,24 @@ static void _beautiful_comand_parser( const char *line)
         lcm_publish( ps_lcm, "EMB6COMMAND", pc_publish_ch, strlen(pc_publish_ch)+1 );
         free(new_channel);
     }
+#if MEMB_STATS
+    if (strncmp(line, "memstat", 7) == 0)
+    {
+        /* report the use of the memory pools */
+        char pc_stats[NODE_INFO_MAX];
+        if (memb_stats_print(pc_stats, NODE_INFO_MAX) > 0)
+        {
+            printf("%s", pc_stats);
+            lcm_publish( ps_lcm, "EMB6COMMAND", pc_stats, strlen(pc_stats)+1 );
+        }
+    }
+#endif /* #if MEMB_STATS */
+#if (NATIVE_CONF_LINK_MODEL == TRUE)
+    if ((strncmp(line, "link", 4) == 0) || (strncmp(line, "collision", 9) == 0))
+    {
+        _native_linkCmd(line);
+    }
+#endif /* #if (NATIVE_CONF_LINK_MODEL == TRUE) */
     if (strncmp(line, "exit", 4) == 0)
     {
         _printAndExit("I've got command to EXIT. Bye!\n");
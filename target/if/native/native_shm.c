@@ -0,0 +1,792 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ * \addtogroup native_radio
+ * @{
+ */
+/*============================================================================*/
+/*! \file   native_shm.c
+
+ \brief  Fake radio transceiver based on shared memory.
+
+         All emulated nodes on a host share one memory segment holding a
+         frame ring per node. A transmitting node pushes its frame into
+         the rings of the nodes that hear it, as given by the network
+         configuration file used by the LCM based driver. The rings are
+         lock-free and accept several producers. A receiver is woken up
+         through a FIFO that is watched by the main loop. The sender only
+         rings this doorbell if the receiver has not been rung since it
+         last drained its ring.
+
+         Every node still runs in a process of its own, the medium is
+         shared between the processes and not within one. Running many
+         nodes in one process needs a stack that keeps its state per
+         instance, which it does not.
+
+ \version 0.1
+ */
+/*============================================================================*/
+
+/*==============================================================================
+                                 INCLUDE FILES
+ ==============================================================================*/
+#include "emb6.h"
+#include "bsp.h"
+#include "board_conf.h"
+#include "packetbuf.h"
+#include "evproc.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if (NATIVE_CONF_RF_SHM == TRUE)
+/*==============================================================================
+                                    MACROS
+ ==============================================================================*/
+#if (HAL_SUPPORT_EVENTWAIT != TRUE)
+#error "the shared memory radio requires HAL_SUPPORT_EVENTWAIT"
+#endif
+
+#define     LOGGER_ENABLE                 LOGGER_RADIO
+#include    "logger.h"
+#define     NODE_INFO_MAX                 2048
+
+#ifndef LCM_NETWORK_CONF
+#define LCM_NETWORK_CONF                  "lcmnetwork.conf"
+#endif /*#ifndef LCM_NETWORK_CONF */
+
+/** Name of the shared memory segment */
+#ifdef NATIVE_CONF_SHM_NAME
+#define NATIVE_SHM_NAME                   NATIVE_CONF_SHM_NAME
+#else
+#define NATIVE_SHM_NAME                   "/emb6_radio"
+#endif /* #ifdef NATIVE_CONF_SHM_NAME */
+
+/** Directory of the doorbell FIFOs */
+#ifdef NATIVE_CONF_SHM_FIFO_DIR
+#define NATIVE_SHM_FIFO_DIR               NATIVE_CONF_SHM_FIFO_DIR
+#else
+#define NATIVE_SHM_FIFO_DIR               "/tmp"
+#endif /* #ifdef NATIVE_CONF_SHM_FIFO_DIR */
+
+/** Maximum number of nodes in the configuration file */
+#ifdef NATIVE_CONF_SHM_NODES
+#define NATIVE_SHM_NODES                  NATIVE_CONF_SHM_NODES
+#else
+#define NATIVE_SHM_NODES                  1024
+#endif /* #ifdef NATIVE_CONF_SHM_NODES */
+
+/** Maximum number of nodes hearing a node */
+#ifdef NATIVE_CONF_SHM_NEIGHBORS
+#define NATIVE_SHM_NEIGHBORS              NATIVE_CONF_SHM_NEIGHBORS
+#else
+#define NATIVE_SHM_NEIGHBORS              64
+#endif /* #ifdef NATIVE_CONF_SHM_NEIGHBORS */
+
+/** Number of frames per receive ring, must be a power of two */
+#ifdef NATIVE_CONF_SHM_RING_SIZE
+#define NATIVE_SHM_RING_SIZE              NATIVE_CONF_SHM_RING_SIZE
+#else
+#define NATIVE_SHM_RING_SIZE              16
+#endif /* #ifdef NATIVE_CONF_SHM_RING_SIZE */
+
+#if (NATIVE_SHM_RING_SIZE & (NATIVE_SHM_RING_SIZE - 1))
+#error "NATIVE_CONF_SHM_RING_SIZE must be a power of two"
+#endif
+
+/** Identifies a segment created with the same layout */
+#define NATIVE_SHM_MAGIC                  ( 0x656D6236UL ^ \
+        ((uint32_t)NATIVE_SHM_NODES << 16) ^ \
+        ((uint32_t)NATIVE_SHM_RING_SIZE << 8) ^ (uint32_t)PACKETBUF_SIZE )
+
+/*==============================================================================
+                             STRUCTURES AND OTHER TYPEDEFS
+ ==============================================================================*/
+/** Slot of a receive ring */
+typedef struct
+{
+    /** Sequence number telling producers and the consumer who owns it */
+    uint32_t l_seq;
+    uint16_t i_len;
+    uint8_t pc_data[PACKETBUF_SIZE];
+} s_shmSlot_t;
+
+/** Receive ring of a node, written by many and read by one process */
+typedef struct
+{
+    uint32_t l_tail;
+    uint32_t l_head;
+    /** Set by the first producer after the consumer has drained */
+    uint32_t l_bell;
+    /** Frames dropped because the ring was full */
+    uint32_t l_drops;
+    s_shmSlot_t ps_slot[NATIVE_SHM_RING_SIZE];
+} s_shmRing_t;
+
+/** Layout of the shared memory segment */
+typedef struct
+{
+    uint32_t l_magic;
+    s_shmRing_t ps_ring[NATIVE_SHM_NODES];
+} s_shmMedium_t;
+
+/*==============================================================================
+                             VARIABLE DECLARATIONS
+ ==============================================================================*/
+/* Pointer to the lmac structure */
+static const s_nsPHY_t* p_phy = NULL;
+extern uip_lladdr_t uip_lladdr;
+/* The shared medium */
+static s_shmMedium_t *ps_medium;
+/* Addresses of all nodes, the index is the one of their ring */
+static uint16_t pi_nodeAddr[NATIVE_SHM_NODES];
+static uint16_t i_nodeCnt;
+/* Index of this node */
+static int32_t l_self = -1;
+/* Rings of the nodes hearing this node */
+static uint16_t pi_nbr[NATIVE_SHM_NEIGHBORS];
+static uint16_t i_nbrCnt;
+/* Doorbell FIFOs, opened lazily for the neighbors */
+static int pl_bellFd[NATIVE_SHM_NEIGHBORS];
+static int l_ownBellFd = -1;
+/* Frame handed to the PHY */
+static uint8_t pc_rxBuf[PACKETBUF_SIZE];
+
+/*==============================================================================
+                             LOCAL FUNCTION PROTOTYPES
+ ==============================================================================*/
+static void _printAndExit( const char* rpc_reason );
+
+static void _shm_init( void *p_netstk, e_nsErr_t *p_err );
+static void _shm_on( e_nsErr_t *p_err );
+static void _shm_off( e_nsErr_t *p_err );
+static void _shm_send( uint8_t *p_data, uint16_t len, e_nsErr_t *p_err );
+static void _shm_recv( uint8_t *p_buf, uint16_t len, e_nsErr_t *p_err );
+static void _shm_ioctl( e_nsIocCmd_t cmd, void *p_val, e_nsErr_t *p_err );
+
+static int32_t _shm_nodeIndex( uint16_t addr );
+static void _shm_readConf( uint16_t ownAddr );
+static void _shm_attach( void );
+static void _shm_bellPath( uint16_t addr, char *pc_path, size_t len );
+static uint8_t _shm_push( s_shmRing_t *ps_ring, const uint8_t *p_data,
+        uint16_t len );
+static int32_t _shm_pop( s_shmRing_t *ps_ring, uint8_t *p_data );
+static void _shm_ioHandler( void* p_data );
+static void _shm_rxPost( uint8_t c_cont );
+static void _shm_rxHandler( c_event_t c_event, p_data_t p_data );
+
+/*==============================================================================
+                                 GLOBAL CONSTANTS
+ ==============================================================================*/
+const s_nsRF_t rf_driver_native_shm = {
+        "RF Native SHM",
+        _shm_init,
+        _shm_on,
+        _shm_off,
+        _shm_send,
+        _shm_recv,
+        _shm_ioctl
+};
+
+/*==============================================================================
+                                     LOCAL FUNCTIONS
+ ==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  This function reports the error and exits back to the shell.
+ *
+ *  \param  rpc_reason  Error to show
+ *  \return Node
+ */
+/*----------------------------------------------------------------------------*/
+static void _printAndExit( const char* rpc_reason )
+{
+    fputs( strerror( errno ), stderr );
+    fputs( ": ", stderr );
+    fputs( rpc_reason, stderr );
+    fputc( '\n', stderr );
+    exit( 1 );
+}
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Find the ring of a node
+ *  \param  addr          Short address of the node
+ *  \return Index of the node or -1 if it is not configured
+ */
+/*----------------------------------------------------------------------------*/
+static int32_t _shm_nodeIndex( uint16_t addr )
+{
+    uint16_t i;
+
+    for( i = 0; i < i_nodeCnt; i++ )
+    {
+        if( pi_nodeAddr[i] == addr )
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Read the network configuration file. Each line holds the
+ *          address of a node followed by the addresses of the nodes that
+ *          hear it. The nodes get their rings in order of their lines.
+ *  \param  ownAddr       Short address of this node
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _shm_readConf( uint16_t ownAddr )
+{
+    FILE* fp;
+    char pc_node_info[NODE_INFO_MAX];
+    uint16_t pi_ownNbr[NATIVE_SHM_NEIGHBORS];
+    uint16_t i_ownNbrCnt = 0;
+    char* pch;
+    uint16_t addr;
+    uint16_t i;
+    int32_t l_idx;
+
+    fp = fopen( LCM_NETWORK_CONF, "r" );
+    if( fp == NULL )
+    {
+        _printAndExit( "Can't open network configuration file" );
+    }
+
+    i_nodeCnt = 0;
+    while( fgets( pc_node_info, NODE_INFO_MAX, fp ) != NULL )
+    {
+        if( pc_node_info[0] == '#' ) continue;
+
+        pch = strtok( pc_node_info, " \t\n," );
+        if( pch == NULL ) continue;
+        if( sscanf( pch, "%hx", &addr ) != 1 ) continue;
+
+        if( i_nodeCnt == NATIVE_SHM_NODES )
+        {
+            _printAndExit( "Too many nodes for NATIVE_CONF_SHM_NODES" );
+        }
+        pi_nodeAddr[i_nodeCnt++] = addr;
+
+        if( addr != ownAddr ) continue;
+
+        /* the nodes hearing this node */
+        while( (pch = strtok( NULL, " \t\n," )) != NULL )
+        {
+            if( (sscanf( pch, "%hx", &addr ) == 1) &&
+                (i_ownNbrCnt < NATIVE_SHM_NEIGHBORS) )
+            {
+                pi_ownNbr[i_ownNbrCnt++] = addr;
+            }
+        }
+    }
+    fclose( fp );
+
+    l_self = _shm_nodeIndex( ownAddr );
+    if( l_self < 0 )
+    {
+        _printAndExit( "Node is missing in the network configuration file" );
+    }
+
+    /* receivers may only be resolved once all lines are read */
+    i_nbrCnt = 0;
+    for( i = 0; i < i_ownNbrCnt; i++ )
+    {
+        l_idx = _shm_nodeIndex( pi_ownNbr[i] );
+        if( l_idx >= 0 )
+        {
+            pl_bellFd[i_nbrCnt] = -1;
+            pi_nbr[i_nbrCnt++] = (uint16_t)l_idx;
+        }
+    }
+    LOG2_INFO( "node %d hears %d of %d nodes", l_self, i_nbrCnt, i_nodeCnt );
+}
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Map the shared medium, the first node creates and formats it.
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _shm_attach( void )
+{
+    int fd;
+    uint8_t c_creator = TRUE;
+    uint32_t i, j;
+
+    fd = shm_open( NATIVE_SHM_NAME, O_RDWR | O_CREAT | O_EXCL, 0600 );
+    if( (fd < 0) && (errno == EEXIST) )
+    {
+        c_creator = FALSE;
+        fd = shm_open( NATIVE_SHM_NAME, O_RDWR, 0600 );
+    }
+    if( (fd < 0) || (ftruncate( fd, sizeof( s_shmMedium_t ) ) != 0) )
+    {
+        _printAndExit( "Can't open the shared radio medium" );
+    }
+
+    ps_medium = mmap( NULL, sizeof( s_shmMedium_t ), PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0 );
+    close( fd );
+    if( ps_medium == MAP_FAILED )
+    {
+        _printAndExit( "Can't map the shared radio medium" );
+    }
+
+    if( c_creator == TRUE )
+    {
+        for( i = 0; i < NATIVE_SHM_NODES; i++ )
+        {
+            for( j = 0; j < NATIVE_SHM_RING_SIZE; j++ )
+            {
+                ps_medium->ps_ring[i].ps_slot[j].l_seq = j;
+            }
+        }
+        __atomic_store_n( &ps_medium->l_magic, NATIVE_SHM_MAGIC,
+                __ATOMIC_RELEASE );
+    }
+    else
+    {
+        /* wait for the creator to format the segment */
+        for( i = 0; (__atomic_load_n( &ps_medium->l_magic, __ATOMIC_ACQUIRE )
+                != NATIVE_SHM_MAGIC); i++ )
+        {
+            if( i == 1000 )
+            {
+                _printAndExit( "Shared radio medium has another layout, "
+                        "remove /dev/shm" NATIVE_SHM_NAME );
+            }
+            usleep( 1000 );
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Get the path of the doorbell FIFO of a node
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _shm_bellPath( uint16_t addr, char *pc_path, size_t len )
+{
+    snprintf( pc_path, len, "%s/emb6_radio_%04x", NATIVE_SHM_FIFO_DIR, addr );
+}
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Put a frame into a ring. Several processes may do so at the
+ *          same time, a slot is claimed by advancing the tail with CAS.
+ *  \return TRUE if the frame was queued, FALSE if the ring is full
+ */
+/*----------------------------------------------------------------------------*/
+static uint8_t _shm_push( s_shmRing_t *ps_ring, const uint8_t *p_data,
+        uint16_t len )
+{
+    s_shmSlot_t *ps_slot;
+    uint32_t l_pos;
+    int32_t l_dif;
+
+    l_pos = __atomic_load_n( &ps_ring->l_tail, __ATOMIC_RELAXED );
+    for( ;; )
+    {
+        ps_slot = &ps_ring->ps_slot[l_pos & (NATIVE_SHM_RING_SIZE - 1)];
+        l_dif = (int32_t)(__atomic_load_n( &ps_slot->l_seq, __ATOMIC_ACQUIRE )
+                - l_pos);
+        if( l_dif == 0 )
+        {
+            if( __atomic_compare_exchange_n( &ps_ring->l_tail, &l_pos,
+                    l_pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+            {
+                break;
+            }
+        }
+        else if( l_dif < 0 )
+        {
+            return FALSE;
+        }
+        else
+        {
+            l_pos = __atomic_load_n( &ps_ring->l_tail, __ATOMIC_RELAXED );
+        }
+    }
+
+    memcpy( ps_slot->pc_data, p_data, len );
+    ps_slot->i_len = len;
+    /* hand the slot to the consumer */
+    __atomic_store_n( &ps_slot->l_seq, l_pos + 1, __ATOMIC_RELEASE );
+    return TRUE;
+}
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Take the oldest frame from the own ring
+ *  \return Length of the frame or -1 if the ring is empty
+ */
+/*----------------------------------------------------------------------------*/
+static int32_t _shm_pop( s_shmRing_t *ps_ring, uint8_t *p_data )
+{
+    s_shmSlot_t *ps_slot;
+    uint32_t l_pos = ps_ring->l_head;
+    int32_t l_len;
+
+    ps_slot = &ps_ring->ps_slot[l_pos & (NATIVE_SHM_RING_SIZE - 1)];
+    if( __atomic_load_n( &ps_slot->l_seq, __ATOMIC_ACQUIRE ) != l_pos + 1 )
+    {
+        return -1;
+    }
+
+    l_len = ps_slot->i_len;
+    memcpy( p_data, ps_slot->pc_data, l_len );
+    /* hand the slot back to the producers for the next round */
+    __atomic_store_n( &ps_slot->l_seq, l_pos + NATIVE_SHM_RING_SIZE,
+            __ATOMIC_RELEASE );
+    ps_ring->l_head = l_pos + 1;
+    return l_len;
+}
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Called by the main loop when the doorbell has been rung
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _shm_ioHandler( void* p_data )
+{
+    char pc_buf[64];
+
+    while( read( l_ownBellFd, pc_buf, sizeof( pc_buf ) ) > 0 );
+
+    /* re-arm the doorbell before looking at the ring, a frame pushed
+     * after that rings again */
+    __atomic_store_n( &ps_medium->ps_ring[l_self].l_bell, 0,
+            __ATOMIC_SEQ_CST );
+    _shm_rxPost( FALSE );
+}
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Post the event handing the frames of the own ring to the PHY.
+ *          If the event queue is full the own doorbell is rung, so the main
+ *          loop retries once the stack has consumed some events.
+ *  \param  c_cont        TRUE to post the continuation of a drain
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _shm_rxPost( uint8_t c_cont )
+{
+    en_evprocResCode_t e_res;
+
+    if( c_cont == TRUE )
+    {
+        e_res = evproc_putTargetEvent( E_EVPROC_TAIL, EVENT_TYPE_PCK_INPUT,
+                ps_medium, _shm_rxHandler );
+    }
+    else
+    {
+        e_res = evproc_putEvent( E_EVPROC_TAIL, EVENT_TYPE_PCK_LL, ps_medium );
+    }
+
+    if( e_res != E_SUCCESS )
+    {
+        LOG_ERR( "Failed to post RX event, retrying" );
+        __atomic_store_n( &ps_medium->ps_ring[l_self].l_bell, 1,
+                __ATOMIC_SEQ_CST );
+        if( write( l_ownBellFd, "", 1 ) < 0 )
+        {
+            /* the FIFO is full, hence readable anyway */
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Hand the oldest received frame to the PHY. The first frame is
+ *          signaled with EVENT_TYPE_PCK_LL of the high priority class, the
+ *          remaining ones with EVENT_TYPE_PCK_INPUT of the normal class, so
+ *          that timer and stack events can interleave.
+ *  \param  c_event       Source of an event.
+ *  \param  p_data        Pointer to the medium
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _shm_rxHandler( c_event_t c_event, p_data_t p_data )
+{
+    e_nsErr_t s_err = NETSTK_ERR_NONE;
+    int32_t l_len;
+
+    if( ((c_event != EVENT_TYPE_PCK_LL) && (c_event != EVENT_TYPE_PCK_INPUT)) ||
+        (p_data != ps_medium) )
+    {
+        return;
+    }
+
+    l_len = _shm_pop( &ps_medium->ps_ring[l_self], pc_rxBuf );
+    if( l_len < 0 )
+    {
+        return;
+    }
+    _shm_rxPost( TRUE );
+
+    LOG_OK( "RX packet [%d]", (int)l_len );
+    packetbuf_clear();
+    packetbuf_set_datalen( (uint16_t)l_len );
+    if( p_phy != NULL )
+    {
+        p_phy->recv( pc_rxBuf, (uint16_t)l_len, &s_err );
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Shared memory transport initialization
+ *  \param  p_netstk      Pointer to the network stack.
+ *  \param  p_err         Result of the initialization.
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _shm_init( void *p_netstk, e_nsErr_t *p_err )
+{
+    linkaddr_t un_addr;
+    char pc_path[NODE_INFO_MAX];
+    uint16_t ownAddr;
+
+#if NETSTK_CFG_ARG_CHK_EN
+    if (p_err == NULL) {
+        return;
+    }
+#endif
+
+    *p_err = NETSTK_ERR_NONE;
+
+    ownAddr = ((uint16_t)mac_phy_config.mac_address[6] << 8) |
+            mac_phy_config.mac_address[7];
+    _shm_readConf( ownAddr );
+    _shm_attach();
+
+    /* a neighbor that exits while its doorbell is open must not kill this
+     * node, the failed write is handled in _shm_send() */
+    signal( SIGPIPE, SIG_IGN );
+
+    /* drop what an earlier run of this node left behind */
+    while( _shm_pop( &ps_medium->ps_ring[l_self], pc_rxBuf ) >= 0 );
+
+    /* the doorbell, opened for writing as well so it never sees EOF */
+    _shm_bellPath( ownAddr, pc_path, sizeof( pc_path ) );
+    if( (mkfifo( pc_path, 0600 ) != 0) && (errno != EEXIST) )
+    {
+        _printAndExit( "Can't create the doorbell FIFO" );
+    }
+    l_ownBellFd = open( pc_path, O_RDWR | O_NONBLOCK );
+    if( l_ownBellFd < 0 )
+    {
+        _printAndExit( "Can't open the doorbell FIFO" );
+    }
+
+    /* Initialise global lladdr structure with a given mac */
+    memcpy( (void *)&un_addr.u8, &mac_phy_config.mac_address, 8 );
+    memcpy( &uip_lladdr.addr, &un_addr.u8, 8 );
+    linkaddr_set_node_addr( &un_addr );
+
+    if( ((s_ns_t*)p_netstk)->phy != NULL )
+    {
+        p_phy = ((s_ns_t*)p_netstk)->phy;
+    }
+    else
+    {
+        _printAndExit( "Bad lmac pointer" );
+        *p_err = NETSTK_ERR_INIT;
+    }
+
+    /* Start the packet receive process */
+    evproc_regCallback( EVENT_TYPE_PCK_LL, _shm_rxHandler );
+    bsp_ioUnregister( l_ownBellFd );
+    if( bsp_ioRegister( l_ownBellFd, _shm_ioHandler, NULL ) != 0 )
+    {
+        _printAndExit( "Error on registering the doorbell FIFO" );
+    }
+    _shm_ioHandler( NULL );
+
+    LOG1_OK( "Native shared memory driver init" );
+} /* _shm_init() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Put a frame into the rings of all nodes hearing this node.
+ *  \param  p_data        Pointer to a payload.
+ *  \param  len           Length of a payload
+ *  \param  p_err         Result of the transmission.
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _shm_send( uint8_t *p_data, uint16_t len, e_nsErr_t *p_err )
+{
+    char pc_path[64];
+    s_shmRing_t *ps_ring;
+    uint16_t i;
+
+#if NETSTK_CFG_ARG_CHK_EN
+    if (p_err == NULL) {
+        return;
+    }
+#endif
+
+    *p_err = NETSTK_ERR_NONE;
+    if( len > PACKETBUF_SIZE )
+    {
+        *p_err = NETSTK_ERR_BUF_OVERFLOW;
+        return;
+    }
+
+    for( i = 0; i < i_nbrCnt; i++ )
+    {
+        ps_ring = &ps_medium->ps_ring[pi_nbr[i]];
+        if( _shm_push( ps_ring, p_data, len ) != TRUE )
+        {
+            /* a full ring is a lost frame on the air */
+            __atomic_fetch_add( &ps_ring->l_drops, 1, __ATOMIC_RELAXED );
+            continue;
+        }
+
+        /* only the first frame after a drain rings the doorbell */
+        if( __atomic_exchange_n( &ps_ring->l_bell, 1, __ATOMIC_SEQ_CST ) == 0 )
+        {
+            if( pl_bellFd[i] < 0 )
+            {
+                _shm_bellPath( pi_nodeAddr[pi_nbr[i]], pc_path,
+                        sizeof( pc_path ) );
+                pl_bellFd[i] = open( pc_path, O_WRONLY | O_NONBLOCK );
+            }
+            if( (pl_bellFd[i] >= 0) && (write( pl_bellFd[i], "", 1 ) < 0) )
+            {
+                /* the node went away, reopen the doorbell on the next frame */
+                close( pl_bellFd[i] );
+                pl_bellFd[i] = -1;
+            }
+            if( pl_bellFd[i] < 0 )
+            {
+                /* the node is not running, it drains its ring on start */
+                __atomic_store_n( &ps_ring->l_bell, 0, __ATOMIC_SEQ_CST );
+            }
+        }
+    }
+    LOG_OK( "TX packet [%d] to %d nodes", len, i_nbrCnt );
+} /* _shm_send() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Shared memory transport wrapper function
+ */
+/*----------------------------------------------------------------------------*/
+static void _shm_on( e_nsErr_t *p_err )
+{
+#if NETSTK_CFG_ARG_CHK_EN
+    if (p_err == NULL) {
+        return;
+    }
+#endif
+
+    *p_err = NETSTK_ERR_NONE;
+} /* _shm_on() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Shared memory transport wrapper function
+ */
+/*----------------------------------------------------------------------------*/
+static void _shm_off( e_nsErr_t *p_err )
+{
+#if NETSTK_CFG_ARG_CHK_EN
+    if (p_err == NULL) {
+        return;
+    }
+#endif
+
+    *p_err = NETSTK_ERR_NONE;
+} /* _shm_off() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Shared memory transport wrapper function
+ */
+/*----------------------------------------------------------------------------*/
+static void _shm_recv( uint8_t *p_buf, uint16_t len, e_nsErr_t *p_err )
+{
+#if NETSTK_CFG_ARG_CHK_EN
+    if (p_err == NULL) {
+        return;
+    }
+#endif
+
+    *p_err = NETSTK_ERR_NONE;
+} /* _shm_recv() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Shared memory transport wrapper function
+ */
+/*----------------------------------------------------------------------------*/
+static void _shm_ioctl( e_nsIocCmd_t cmd, void *p_val, e_nsErr_t *p_err )
+{
+#if NETSTK_CFG_ARG_CHK_EN
+    if (p_err == NULL) {
+        return;
+    }
+#endif
+
+    *p_err = NETSTK_ERR_NONE;
+    switch( cmd )
+    {
+        case NETSTK_CMD_RF_TXPOWER_SET:
+        case NETSTK_CMD_RF_CHAN_NUM_SET:
+        case NETSTK_CMD_RF_OP_MODE_SET:
+        case NETSTK_CMD_RF_WOR_EN:
+            /* accepted, the simulated medium has a single channel */
+            break;
+
+        case NETSTK_CMD_RF_CCA_GET:
+        case NETSTK_CMD_RF_IS_RX_BUSY:
+            /* the channel is clear and frames arrive in one piece */
+            break;
+
+        default:
+            /* unsupported commands are treated in same way */
+            *p_err = NETSTK_ERR_CMD_UNSUPPORTED;
+            break;
+    }
+} /* _shm_ioctl() */
+
+/*==============================================================================
+ API FUNCTIONS
+ ==============================================================================*/
+#endif /* #if (NATIVE_CONF_RF_SHM == TRUE) */
+/** @} */
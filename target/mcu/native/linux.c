@@ -73,6 +73,13 @@
 #include <stdlib.h>
 #include "hal.h"
 
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
+#include "rt_tmr.h"
+
 
 /*
  *  --- Macros ------------------------------------------------------------- *
@@ -82,6 +89,44 @@
 
 #define NATIVE_TICK_SECONDS       ( 1000u )
 
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+/** Maximum number of descriptors the main loop can wait on */
+#ifdef NATIVE_CONF_IO_MAX
+#define NATIVE_IO_MAX             NATIVE_CONF_IO_MAX
+#else
+#define NATIVE_IO_MAX             ( 8u )
+#endif /* #ifdef NATIVE_CONF_IO_MAX */
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
+
+/** Run on a simulation clock instead of the wall clock. The clock jumps
+ * to the next timer expiration whenever the stack has nothing to do.
+ *
+ * The mode is restricted to a single node that does not share a radio
+ * medium with other processes. Every process advances its own clock as
+ * soon as it is idle and the clocks are not synchronized, so the clocks of
+ * nodes in different processes would drift apart arbitrarily. Hence the
+ * shared memory radio is rejected at build time and the LCM radio refuses
+ * a node that has neighbours or receives a frame. */
+#ifdef NATIVE_CONF_VIRTUAL_TIME
+#define NATIVE_VIRTUAL_TIME       NATIVE_CONF_VIRTUAL_TIME
+#else
+#define NATIVE_VIRTUAL_TIME       FALSE
+#endif /* #ifdef NATIVE_CONF_VIRTUAL_TIME */
+
+/** Seed of the random numbers if the simulation clock is used */
+#ifdef NATIVE_CONF_SIM_SEED
+#define NATIVE_SIM_SEED           NATIVE_CONF_SIM_SEED
+#else
+#define NATIVE_SIM_SEED           ( 1u )
+#endif /* #ifdef NATIVE_CONF_SIM_SEED */
+
+/** Microseconds per tick */
+#define NATIVE_TICK_US            ( 1000000u / NATIVE_TICK_SECONDS )
+
+#if (NATIVE_VIRTUAL_TIME == TRUE) && (HAL_SUPPORT_EVENTWAIT != TRUE)
+#error "The simulation clock requires HAL_SUPPORT_EVENTWAIT"
+#endif
+
 /*
  * --- Type Definitions -----------------------------------------------------*
  */
@@ -94,6 +139,19 @@ typedef struct
 
 } s_hal_irq;
 
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+typedef struct
+{
+  /** file descriptor, -1 if the entry is free */
+  int32_t fd;
+  /** callback function */
+  pf_hal_irqCb_t pf_cb;
+  /** data pointer */
+  void* p_data;
+
+} s_hal_io;
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
+
 
 /*
  *  --- Local Variables ---------------------------------------------------- *
@@ -101,13 +159,32 @@ typedef struct
 /** Definition of the peripheral callback functions */
 static s_hal_irq s_hal_irqs[EN_HAL_PERIPHIRQ_MAX];
 
+#if (NATIVE_VIRTUAL_TIME == TRUE)
+/** Simulation time in microseconds. It starts at one second so that no
+ * timer expires at tick 0, which means "not active" to the etimers. */
+static uint64_t gl_simTimeUs = 1000000u;
+/** State of the random number generator */
+static uint32_t gi_simRand = NATIVE_SIM_SEED;
+#else
 static struct timespec tim = { 0, 0 };
+#endif /* #if (NATIVE_VIRTUAL_TIME == TRUE) */
 
 #if defined(HAL_SUPPORT_SLIPUART)
 static int fdm = -1;
 static pf_hal_irqCb_t isr_rxCallb = NULL;
 #endif /* #if defined(HAL_SUPPORT_SLIPUART) */
 
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+/** epoll instance the main loop blocks on */
+static int epfd = -1;
+/** timer descriptor bounding the wait to the next timer expiration */
+static int tmrfd = -1;
+/** descriptors registered by the upper layers */
+static s_hal_io s_hal_ios[NATIVE_IO_MAX];
+/** signal mask used while waiting, SIGIO is only delivered in there */
+static sigset_t s_waitMask;
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
+
 
 /*
  *  --- Local Function Prototypes ------------------------------------------ *
@@ -117,6 +194,12 @@ static void _printAndExit( const char* rpc_reason );
 static void signal_handler_IO (int status);
 static void signal_handler_interrupt(int signum);
 #endif /* #if defined(HAL_SUPPORT_SLIPUART) */
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+static int8_t _waitInit( void );
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
+#if (NATIVE_VIRTUAL_TIME == TRUE)
+static uint8_t _simAdvance( uint64_t us );
+#endif /* #if (NATIVE_VIRTUAL_TIME == TRUE) */
 
 
 /*
@@ -175,6 +258,93 @@ static void signal_handler_interrupt(int signum)
 } /* signal_handler_interrupt() */
 #endif /* #if defined(HAL_SUPPORT_SLIPUART) */
 
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+/*---------------------------------------------------------------------------*/
+/*
+* _waitInit()
+*/
+static int8_t _waitInit( void )
+{
+  struct epoll_event ev;
+  sigset_t blockMask;
+  uint8_t i;
+
+  for( i = 0; i < NATIVE_IO_MAX; i++ )
+  {
+    s_hal_ios[i].fd = -1;
+    s_hal_ios[i].pf_cb = NULL;
+    s_hal_ios[i].p_data = NULL;
+  }
+
+  epfd = epoll_create1( EPOLL_CLOEXEC );
+  if( epfd < 0 )
+  {
+    return -1;
+  }
+
+  tmrfd = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+  if( tmrfd < 0 )
+  {
+    return -1;
+  }
+
+  /* the timer descriptor is told apart from the registered ones by
+   * its NULL data pointer */
+  memset( &ev, 0, sizeof(ev) );
+  ev.events = EPOLLIN;
+  ev.data.ptr = NULL;
+  if( epoll_ctl( epfd, EPOLL_CTL_ADD, tmrfd, &ev ) < 0 )
+  {
+    return -1;
+  }
+
+  /* SIGIO is kept blocked outside of hal_waitEvent(). A byte arriving on
+   * the SLIP interface while the stack is busy is then reported by the
+   * next wait instead of being lost between the check and the sleep. */
+  sigemptyset( &blockMask );
+  sigaddset( &blockMask, SIGIO );
+  sigprocmask( SIG_BLOCK, &blockMask, &s_waitMask );
+  sigdelset( &s_waitMask, SIGIO );
+
+  return 0;
+} /* _waitInit() */
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
+
+#if (NATIVE_VIRTUAL_TIME == TRUE)
+/*---------------------------------------------------------------------------*/
+/*
+* _simAdvance()
+*
+* Advance the simulation clock by the given time. The real-time timers
+* advance with it. The clock stops at the first tick a real-time timer
+* expires at since its callback may have produced work.
+*
+* Returns TRUE if the clock stopped early because of a real-time timer.
+*/
+static uint8_t _simAdvance( uint64_t us )
+{
+  uint64_t target = gl_simTimeUs + us;
+  uint64_t ticks = (target / NATIVE_TICK_US) - (gl_simTimeUs / NATIVE_TICK_US);
+  rt_tmr_tick_t passed;
+
+  if( ticks > UINT32_MAX )
+  {
+    ticks = UINT32_MAX;
+    target = ((gl_simTimeUs / NATIVE_TICK_US) + ticks) * NATIVE_TICK_US;
+  }
+
+  passed = rt_tmr_advance( (rt_tmr_tick_t)ticks );
+  if( passed < ticks )
+  {
+    gl_simTimeUs = ((gl_simTimeUs / NATIVE_TICK_US) + passed) * NATIVE_TICK_US;
+    return TRUE;
+  }
+
+  gl_simTimeUs = target;
+  return FALSE;
+} /* _simAdvance() */
+#endif /* #if (NATIVE_VIRTUAL_TIME == TRUE) */
+
 
 /*
  * --- Global Function Definitions ----------------------------------------- *
@@ -225,6 +395,14 @@ int8_t hal_init( void )
   }
 #endif /* #if defined(HAL_SUPPORT_SLIPUART) */
 
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+  if( _waitInit() != 0 )
+  {
+    LOG_ERR( "%s\n\r", "failed to set up the event wait" );
+    return -1;
+  }
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
+
   return 0;
 } /* hal_init() */
 
@@ -284,10 +462,18 @@ int8_t hal_watchdogStop( void )
 */
 uint32_t hal_getrand( void )
 {
+#if (NATIVE_VIRTUAL_TIME == TRUE)
+  /* reproducible xorshift sequence */
+  gi_simRand ^= gi_simRand << 13;
+  gi_simRand ^= gi_simRand >> 17;
+  gi_simRand ^= gi_simRand << 5;
+  return ((uint8_t) gi_simRand);
+#else
   // We don't need special kind of seed or rand.
   srand(time(NULL));
   int r = rand();
   return ((uint8_t) r);
+#endif /* #if (NATIVE_VIRTUAL_TIME == TRUE) */
 } /* hal_getrand() */
 
 /*---------------------------------------------------------------------------*/
@@ -296,9 +482,13 @@ uint32_t hal_getrand( void )
 */
 clock_time_t hal_getTick( void )
 {
+#if (NATIVE_VIRTUAL_TIME == TRUE)
+  return ((gl_simTimeUs / NATIVE_TICK_US) & 0xffffffff);
+#else
   struct timeval tv;
   gettimeofday(&tv, NULL);
   return ((tv.tv_sec * NATIVE_TICK_SECONDS + tv.tv_usec / NATIVE_TICK_SECONDS) & 0xffffffff);
+#endif /* #if (NATIVE_VIRTUAL_TIME == TRUE) */
 } /* hal_getTick() */
 
 /*---------------------------------------------------------------------------*/
@@ -307,9 +497,13 @@ clock_time_t hal_getTick( void )
 */
 clock_time_t hal_getSec( void )
 {
+#if (NATIVE_VIRTUAL_TIME == TRUE)
+  return (clock_time_t)(gl_simTimeUs / 1000000u);
+#else
   struct timeval tv;
   gettimeofday(&tv, NULL);
   return tv.tv_sec;
+#endif /* #if (NATIVE_VIRTUAL_TIME == TRUE) */
 } /* hal_getSec() */
 
 /*---------------------------------------------------------------------------*/
@@ -327,8 +521,18 @@ clock_time_t hal_getTRes( void )
 */
 int8_t hal_delayUs( uint32_t delay )
 {
+#if (NATIVE_VIRTUAL_TIME == TRUE)
+  /* busy waits take simulation time only */
+  uint64_t target = gl_simTimeUs + delay;
+
+  while( gl_simTimeUs < target )
+  {
+    _simAdvance( target - gl_simTimeUs );
+  }
+#else
   tim.tv_nsec = delay * 1000;
   nanosleep(&tim, NULL);
+#endif /* #if (NATIVE_VIRTUAL_TIME == TRUE) */
   return 0;
 } /* hal_delayUs() */
 
@@ -454,3 +658,151 @@ int8_t hal_debugInit( void )
 {
   return 0;
 } /* hal_debugInit() */
+
+#if (HAL_SUPPORT_EVENTWAIT == TRUE)
+/*---------------------------------------------------------------------------*/
+/*
+* hal_ioRegister()
+*/
+int8_t hal_ioRegister( int32_t fd, pf_hal_irqCb_t pf_cb, void* p_data )
+{
+  struct epoll_event ev;
+  uint8_t i;
+
+  if( (fd < 0) || (pf_cb == NULL) || (epfd < 0) )
+  {
+    return -1;
+  }
+
+  for( i = 0; i < NATIVE_IO_MAX; i++ )
+  {
+    if( s_hal_ios[i].fd == -1 )
+    {
+      break;
+    }
+  }
+  if( i == NATIVE_IO_MAX )
+  {
+    return -1;
+  }
+
+  memset( &ev, 0, sizeof(ev) );
+  ev.events = EPOLLIN;
+  ev.data.ptr = &s_hal_ios[i];
+  if( epoll_ctl( epfd, EPOLL_CTL_ADD, fd, &ev ) < 0 )
+  {
+    return -1;
+  }
+
+  s_hal_ios[i].fd = fd;
+  s_hal_ios[i].pf_cb = pf_cb;
+  s_hal_ios[i].p_data = p_data;
+
+  return 0;
+} /* hal_ioRegister() */
+
+/*---------------------------------------------------------------------------*/
+/*
+* hal_ioUnregister()
+*/
+int8_t hal_ioUnregister( int32_t fd )
+{
+  uint8_t i;
+
+  for( i = 0; i < NATIVE_IO_MAX; i++ )
+  {
+    if( (fd >= 0) && (s_hal_ios[i].fd == fd) )
+    {
+      epoll_ctl( epfd, EPOLL_CTL_DEL, fd, NULL );
+      s_hal_ios[i].fd = -1;
+      s_hal_ios[i].pf_cb = NULL;
+      s_hal_ios[i].p_data = NULL;
+      return 0;
+    }
+  }
+
+  return -1;
+} /* hal_ioUnregister() */
+
+/*---------------------------------------------------------------------------*/
+/*
+* hal_waitEvent()
+*/
+int8_t hal_waitEvent( int32_t us_timeout )
+{
+  struct epoll_event evs[NATIVE_IO_MAX + 1];
+#if (NATIVE_VIRTUAL_TIME != TRUE)
+  struct itimerspec its;
+  uint64_t expCnt;
+#endif /* #if (NATIVE_VIRTUAL_TIME != TRUE) */
+  s_hal_io* ps_io;
+  int timeout;
+  int n;
+  int i;
+
+  if( epfd < 0 )
+  {
+    return -1;
+  }
+
+#if (NATIVE_VIRTUAL_TIME == TRUE)
+  /* Time does not pass while waiting. Pending inputs are polled and only
+   * if there are none the clock jumps to the next timer expiration. If no
+   * timer is running at all only an input can produce new work. */
+  timeout = ((us_timeout >= 0) || (rt_tmr_getNext() != NULL)) ? 0 : -1;
+  n = epoll_pwait( epfd, evs, NATIVE_IO_MAX + 1, timeout, &s_waitMask );
+
+  if( (n == 0) && (us_timeout > 0) )
+  {
+    _simAdvance( us_timeout );
+  }
+  else if( (n == 0) && (us_timeout < 0) && (rt_tmr_getNext() != NULL) )
+  {
+    _simAdvance( (uint64_t)rt_tmr_getRemain( rt_tmr_getNext() ) *
+        NATIVE_TICK_US );
+  }
+#else
+  /* epoll only has a millisecond resolution, sub-millisecond timeouts are
+   * served by the timer descriptor instead */
+  memset( &its, 0, sizeof(its) );
+  timeout = -1;
+  if( us_timeout == 0 )
+  {
+    timeout = 0;
+  }
+  else if( us_timeout > 0 )
+  {
+    its.it_value.tv_sec = us_timeout / 1000000;
+    its.it_value.tv_nsec = (us_timeout % 1000000) * 1000;
+    timerfd_settime( tmrfd, 0, &its, NULL );
+  }
+
+  n = epoll_pwait( epfd, evs, NATIVE_IO_MAX + 1, timeout, &s_waitMask );
+
+  if( us_timeout > 0 )
+  {
+    /* disarm and drain, the timer is re-armed on every wait */
+    memset( &its, 0, sizeof(its) );
+    timerfd_settime( tmrfd, 0, &its, NULL );
+    while( read( tmrfd, &expCnt, sizeof(expCnt) ) > 0 );
+  }
+#endif /* #if (NATIVE_VIRTUAL_TIME == TRUE) */
+
+  if( n < 0 )
+  {
+    /* a signal (e.g. SIGIO of the SLIP interface) woke us up */
+    return (errno == EINTR) ? 0 : -1;
+  }
+
+  for( i = 0; i < n; i++ )
+  {
+    ps_io = (s_hal_io*)evs[i].data.ptr;
+    if( (ps_io != NULL) && (ps_io->pf_cb != NULL) )
+    {
+      ps_io->pf_cb( ps_io->p_data );
+    }
+  }
+
+  return 0;
+} /* hal_waitEvent() */
+#endif /* #if (HAL_SUPPORT_EVENTWAIT == TRUE) */
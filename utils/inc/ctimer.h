@@ -82,8 +82,8 @@ typedef void (*fn_ctimer_cb_t)(void*);
  */
 struct ctimer
 {
-    /** Pointer to the next timer structure in the timer list */
-    struct ctimer *next;
+    /** Flag indicating whether the callback timer is pending */
+    uint8_t pending;
 
     /** An event timer that is used for the callback timer */
     struct etimer etimer;
@@ -0,0 +1,154 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ *   \addtogroup utils
+ *   @{ */
+/** \addtogroup lib
+    @{ */
+/**
+ * \defgroup dlist Double linked list library
+ *
+ * The double linked list library is a drop-in companion of the list
+ * library. In addition to the first element, a double linked list
+ * keeps a pointer to its last element and each element keeps a pointer
+ * to its predecessor. Appending, popping, chopping and removing a
+ * known element thus take constant time instead of a scan of the list.
+ *
+ * An element of a double linked list \b must be a structure whose
+ * first element is a pointer to the next element and whose second
+ * element is a pointer to the previous element. Iterating with
+ * list_item_next() or through the next pointer works as for a list.
+ *
+ * Both pointers of an element must be NULL while it is not on a list,
+ * e.g. by allocating it from zeroed memory or by calling
+ * dlist_item_init(). The library keeps them NULL after an element has
+ * been removed. This allows dlist_add() and dlist_push() to move an
+ * element that is already on the list, as list_add() and list_push()
+ * do, without scanning.
+ *
+ * A module migrates from LIST() to DLIST() by adding the previous
+ * pointer to its element structure and replacing the list_ calls by
+ * their dlist_ counterparts.
+ *
+ * @{
+ */
+
+/**
+ * \file
+ * Double linked list manipulation routines.
+ */
+
+#ifndef DLIST_H_
+#define DLIST_H_
+
+#include "clist.h"
+
+/**
+ * The anchor of a double linked list.
+ */
+struct dlist {
+  void *head;
+  void *tail;
+  int len;
+};
+
+/**
+ * The double linked list type.
+ */
+typedef struct dlist * dlist_t;
+
+/**
+ * Declare a double linked list.
+ *
+ * The list variable is declared as static as for LIST().
+ *
+ * \param name The name of the list.
+ */
+#define DLIST(name) \
+         static struct dlist LIST_CONCAT(name,_dlist) = { NULL, NULL, 0 }; \
+         static dlist_t name = &LIST_CONCAT(name,_dlist)
+
+/**
+ * Declare a double linked list inside a structure declaraction.
+ *
+ * The list is initialized with the DLIST_STRUCT_INIT() macro.
+ *
+ * \param name The name of the list.
+ */
+#define DLIST_STRUCT(name) \
+         struct dlist LIST_CONCAT(name,_dlist); \
+         dlist_t name
+
+/**
+ * Initialize a double linked list that is part of a structure.
+ *
+ * \param struct_ptr A pointer to the struct
+ * \param name The name of the list.
+ */
+#define DLIST_STRUCT_INIT(struct_ptr, name)                             \
+    do {                                                                \
+       (struct_ptr)->name = &((struct_ptr)->LIST_CONCAT(name,_dlist));  \
+       dlist_init((struct_ptr)->name);                                  \
+    } while(0)
+
+void   dlist_init(dlist_t list);
+void * dlist_head(dlist_t list);
+void * dlist_tail(dlist_t list);
+void * dlist_pop (dlist_t list);
+void   dlist_push(dlist_t list, void *item);
+
+void * dlist_chop(dlist_t list);
+
+void   dlist_add(dlist_t list, void *item);
+void   dlist_remove(dlist_t list, void *item);
+
+int    dlist_length(dlist_t list);
+
+void   dlist_insert(dlist_t list, void *previtem, void *newitem);
+
+void   dlist_item_init(void *item);
+void * dlist_item_prev(void *item);
+
+#endif /* DLIST_H_ */
+
+/** @} */
+/** @} */
+/** @} */
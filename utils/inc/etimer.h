@@ -77,6 +77,32 @@
 /** Timer is active */
 #define TMR_NOT_ACTIVE            0
 
+/** Use a binary heap instead of a list to manage the active event timers.
+ * Polling the timers and getting the next expiration time then do not
+ * depend on the number of active timers anymore. */
+#ifdef ETIMER_CONF_HEAP
+#define ETIMER_HEAP               ETIMER_CONF_HEAP
+#else
+#define ETIMER_HEAP               FALSE
+#endif /* #ifdef ETIMER_CONF_HEAP */
+
+/** Number of active event timers the heap can hold. Further timers are kept
+ * in an overflow list that is searched linearly until the heap has room for
+ * them again, so ETIMER_HEAP_SIZE should cover the usual number of active
+ * timers. */
+#ifdef ETIMER_CONF_HEAP_SIZE
+#define ETIMER_HEAP_SIZE          ETIMER_CONF_HEAP_SIZE
+#else
+#define ETIMER_HEAP_SIZE          64
+#endif /* #ifdef ETIMER_CONF_HEAP_SIZE */
+
+/** Collect runtime statistics of the event timers */
+#ifdef ETIMER_CONF_STATS
+#define ETIMER_STATS              ETIMER_CONF_STATS
+#else
+#define ETIMER_STATS              FALSE
+#endif /* #ifdef ETIMER_CONF_STATS */
+
 
 /*
  *  --- Type Definitions -----------------------------------------------------*
@@ -98,8 +124,43 @@ struct etimer
 
     /** Flag indicating whether etimer has expired or not. */
     uint8_t active;
+
+    /** Callback the expiration event is dispatched to. */
+    pfn_callback_t callback;
+
+#if ( ETIMER_HEAP == TRUE )
+    /** Position of the timer within the timer heap. */
+    uint16_t heapIdx;
+#endif /* #if ( ETIMER_HEAP == TRUE ) */
 };
 
+#if ( ETIMER_STATS == TRUE )
+/**
+ * \brief   Runtime statistics of the event timers.
+ *
+ *          The lateness of a timer is the time between its expiration time
+ *          and the poll that detected the expiration, in system ticks.
+ */
+typedef struct
+{
+    /** Number of expired timers */
+    uint32_t l_fired;
+
+    /** Cumulative lateness of the expired timers */
+    uint32_t l_latenessSum;
+
+    /** Maximum lateness of an expired timer */
+    uint32_t l_latenessMax;
+
+    /** Number of expired timers whose event could not be queued */
+    uint32_t l_lost;
+
+    /** Number of timers that were started while the heap was full */
+    uint32_t l_overflow;
+
+} st_etimerStats_t;
+#endif /* #if ( ETIMER_STATS == TRUE ) */
+
 
 /*
  *  --- Global Functions Definition ------------------------------------------*
@@ -136,8 +197,8 @@ void etimer_request_poll(void);
  *
  *          This function is used to set an event timer for a time
  *          sometime in the future. When the event timer expires,
- *          an according event will be posted to the and the associated
- *          callback will be called.
+ *          an according event will be posted to the event queue and
+ *          only the associated callback will be called.
  *
  * \param   et          Pointer to the event timer.
  * \param   interval    The interval before the timer expires.
@@ -282,5 +343,28 @@ clock_time_t etimer_start_time( struct etimer* et );
 clock_time_t etimer_nextEvent( void );
 
 
+#if ( ETIMER_STATS == TRUE )
+/**
+ * etimer_getStats()
+ *
+ * \brief   Get the runtime statistics of the event timers.
+ *
+ *          The statistics are collected since the initialization of the
+ *          module or the last call of etimer_resetStats().
+ *
+ * \param   ps_stats  Statistics to fill.
+ */
+void etimer_getStats( st_etimerStats_t* ps_stats );
+
+
+/**
+ * etimer_resetStats()
+ *
+ * \brief   Reset the runtime statistics of the event timers.
+ */
+void etimer_resetStats( void );
+#endif /* #if ( ETIMER_STATS == TRUE ) */
+
+
 #endif /* __ETIMER_H__ */
 
@@ -79,8 +79,35 @@
 /** Maximum amount of callbacks allowed */
 #define MAX_CALLBACK_COUNT                  ( 13U )
 
-/** Maximum number of events that can be queued */
-#define EVPROC_QUEUE_SIZE                   ( 20U )
+/** Maximum number of events that can be queued per priority class
+ * (must be a power of two) */
+#ifdef EVPROC_CONF_QUEUE_SIZE
+#define EVPROC_QUEUE_SIZE                   EVPROC_CONF_QUEUE_SIZE
+#else
+#define EVPROC_QUEUE_SIZE                   ( 32U )
+#endif /* #ifdef EVPROC_CONF_QUEUE_SIZE */
+
+/** Collect runtime statistics of the event processing. See
+ * st_evprocCbStat_t for the resolution of the execution times. */
+#ifdef EVPROC_CONF_STATS
+#define EVPROC_STATS                        EVPROC_CONF_STATS
+#else
+#define EVPROC_STATS                        FALSE
+#endif /* #ifdef EVPROC_CONF_STATS */
+
+/** Maximum number of callbacks the execution time is tracked for
+ * (must be a power of two) */
+#ifdef EVPROC_CONF_STATS_CB_MAX
+#define EVPROC_STATS_CB_MAX                 EVPROC_CONF_STATS_CB_MAX
+#else
+#define EVPROC_STATS_CB_MAX                 ( 32U )
+#endif /* #ifdef EVPROC_CONF_STATS_CB_MAX */
+
+/** Number of priority classes, see en_evprocPrio_t */
+#define EVPROC_PRIO_CLASSES                 ( 3U )
+
+/** Maximum number of events that can be queued in all classes together */
+#define EVPROC_QUEUE_TOTAL                  ( EVPROC_PRIO_CLASSES * EVPROC_QUEUE_SIZE )
 
 
 
@@ -174,6 +201,42 @@ typedef enum
 
 }en_evprocResCode_t;
 
+/**
+ * \brief Priority classes of the events.
+ *
+ *        Every class has its own queue. Queued events are served strictly
+ *        by their class, i.e. an event is only taken from a queue if all
+ *        the queues of higher priority are empty.
+ */
+typedef enum
+{
+    /** Latency critical radio, MAC and TSCH events */
+    E_EVPROC_PRIO_HIGH,
+
+    /** Packet input, timer and stack events */
+    E_EVPROC_PRIO_NORMAL,
+
+    /** Application polls and requests */
+    E_EVPROC_PRIO_LOW,
+
+    /** Number of priority classes */
+    E_EVPROC_PRIO_MAX
+
+}en_evprocPrio_t;
+
+/**
+ * \brief Statistic of the queue of a priority class.
+ */
+typedef struct
+{
+    /** Number of currently queued events */
+    uint16_t i_depth;
+
+    /** Maximum number of queued events since initialization */
+    uint16_t i_maxDepth;
+
+}st_evprocQueueStat_t;
+
 /*!
  * \brief Different type of actions to work with events queue
  */
@@ -200,6 +263,60 @@ typedef void* p_data_t;
 /** Type of a callback function */
 typedef void (*pfn_callback_t)( c_event_t c_event, p_data_t p_data );
 
+#if (EVPROC_STATS == TRUE)
+/**
+ * \brief Execution statistic of a callback.
+ *
+ *          Execution times are given in the unit of the time source
+ *          EVPROC_CONF_STATS_TIME(). It defaults to the rtimer ticks on
+ *          targets with HAL_SUPPORT_RTIMER and to the system ticks of
+ *          bsp_getTick() otherwise. A system tick usually is a millisecond,
+ *          so most callbacks account an execution time of zero then and
+ *          only l_calls is meaningful. A target can define
+ *          EVPROC_CONF_STATS_TIME() to a free running microsecond counter.
+ */
+typedef struct
+{
+    /** Callback the statistic belongs to, NULL if the entry is unused */
+    pfn_callback_t pfn_callback;
+
+    /** Number of calls */
+    uint32_t l_calls;
+
+    /** Cumulative execution time */
+    uint32_t l_timeSum;
+
+    /** Maximum execution time of a single call */
+    uint32_t l_timeMax;
+
+} st_evprocCbStat_t;
+
+
+/**
+ * \brief Runtime statistics of the event processing.
+ */
+typedef struct
+{
+    /** Number of dispatched events per event type */
+    uint32_t pl_dispatchCnt[EVENT_TYPE_MAX];
+
+    /** Number of events dropped because their queue was full */
+    uint32_t l_dropCnt;
+
+    /** Maximum number of queued events per priority class */
+    uint16_t pi_maxDepth[E_EVPROC_PRIO_MAX];
+
+    /** Execution statistic of the callbacks */
+    st_evprocCbStat_t pst_cbStat[EVPROC_STATS_CB_MAX];
+
+    /** Number of calls of callbacks that did not fit into pst_cbStat */
+    uint32_t l_cbUntracked;
+
+} st_evprocStats_t;
+#endif /* #if (EVPROC_STATS == TRUE) */
+
+
+
 
 /*
  *  --- Global Functions Definition ------------------------------------------*
@@ -274,17 +391,81 @@ en_evprocResCode_t evproc_putEvent( en_evprocAction_t e_actType,
     c_event_t c_eventType, p_data_t p_data );
 
 
+/**
+ * evproc_putTargetEvent()
+ *
+ * \brief   Process input event for a specific callback.
+ *
+ *          In contrast to evproc_putEvent() the event is not dispatched
+ *          to all the callbacks registered for the event type but only
+ *          to the given target callback. The target callback does not
+ *          need to be registered. This avoids waking up every subscriber
+ *          for events that are of interest to a single module only
+ *          (e.g. expired event timers).
+ *
+ * \param   e_actType     Action type what should be done with this event.
+ * \param   c_eventType   Type of event to put/execute.
+ * \param   p_data        Specific data that can be used in the callback.
+ * \param   pfn_target    Callback to dispatch the event to. If NULL the
+ *                        event is dispatched to all registered callbacks.
+ *
+ * \return  Error code from according enumeration.
+ */
+en_evprocResCode_t evproc_putTargetEvent( en_evprocAction_t e_actType,
+    c_event_t c_eventType, p_data_t p_data, pfn_callback_t pfn_target );
+
+
 /**
  * evproc_nextEvent()
  *
  * \brief   Process next event from the event queue.
  *
- *          This function takes the next event from the queue and calls
- *          the registered callbacks.
+ *          This function takes the next event from the non-empty queue
+ *          of the highest priority class and calls the registered
+ *          callbacks.
  *
  * \return  Error code from according enumeration.
  */
 en_evprocResCode_t evproc_nextEvent( void );
 
+
+/**
+ * evproc_getQueueStat()
+ *
+ * \brief   Get the statistic of the queue of a priority class.
+ *
+ * \param   e_prio     Priority class to get the statistic of.
+ * \param   ps_stat    Statistic to fill.
+ *
+ * \return  Error code from according enumeration.
+ */
+en_evprocResCode_t evproc_getQueueStat( en_evprocPrio_t e_prio,
+    st_evprocQueueStat_t* ps_stat );
+
+
+#if (EVPROC_STATS == TRUE)
+/**
+ * evproc_getStats()
+ *
+ * \brief   Get the runtime statistics of the event processing.
+ *
+ *          The statistics are collected since the initialization of the
+ *          module or the last call of evproc_resetStats().
+ *
+ * \param   ps_stats   Statistics to fill.
+ *
+ * \return  Error code from according enumeration.
+ */
+en_evprocResCode_t evproc_getStats( st_evprocStats_t* ps_stats );
+
+
+/**
+ * evproc_resetStats()
+ *
+ * \brief   Reset the runtime statistics of the event processing.
+ */
+void evproc_resetStats( void );
+#endif /* #if (EVPROC_STATS == TRUE) */
+
 #endif /* __EVPROC_H__*/
 
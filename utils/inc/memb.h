@@ -68,6 +68,54 @@
 
 #include "cc.h"
 
+/**
+ * Allocate and free memory blocks in constant time.
+ *
+ * The default implementation searches the blocks linearly. If
+ * MEMB_CONF_FAST is set, every memory block additionally keeps a
+ * stack of the freed blocks and the blocks that have never been
+ * allocated are handed out in order. memb_alloc(), memb_free() and
+ * memb_numfree() then take constant time at the cost of four bytes per
+ * block. memb_allocm() still searches for a contiguous run of blocks.
+ */
+#ifdef MEMB_CONF_FAST
+#define MEMB_FAST MEMB_CONF_FAST
+#else
+#define MEMB_FAST 0
+#endif /* MEMB_CONF_FAST */
+
+/**
+ * Track the use of every memory block.
+ *
+ * If MEMB_CONF_STATS is set, every memory block keeps its name, the
+ * number of allocated blocks, the peak number of allocated blocks and
+ * the number of failed allocations. A memory block adds itself to a
+ * registry on its first use, the registry can be printed with
+ * memb_stats_print().
+ */
+#ifdef MEMB_CONF_STATS
+#define MEMB_STATS MEMB_CONF_STATS
+#else
+#define MEMB_STATS 0
+#endif /* MEMB_CONF_STATS */
+
+#if MEMB_FAST
+#define MEMB_FAST_DECL(name, num) \
+        static unsigned short CC_CONCAT(name,_memb_free)[num]; \
+        static unsigned short CC_CONCAT(name,_memb_pos)[num];
+#define MEMB_FAST_INIT(name) \
+        , CC_CONCAT(name,_memb_free), CC_CONCAT(name,_memb_pos), 0, 0
+#else
+#define MEMB_FAST_DECL(name, num)
+#define MEMB_FAST_INIT(name)
+#endif /* MEMB_FAST */
+
+#if MEMB_STATS
+#define MEMB_STATS_INIT(name) , #name, NULL, 0, 0, 0, 0
+#else
+#define MEMB_STATS_INIT(name)
+#endif /* MEMB_STATS */
+
 /**
  * Declare a memory block.
  *
@@ -92,15 +140,42 @@ MEMB(connections, struct connection, 16);
 #define MEMB(name, structure, num) \
         static char CC_CONCAT(name,_memb_count)[num]; \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
+        MEMB_FAST_DECL(name, num) \
         static struct memb name = {sizeof(structure), num, \
                                           CC_CONCAT(name,_memb_count), \
-                                          (void *)CC_CONCAT(name,_memb_mem)}
+                                          (void *)CC_CONCAT(name,_memb_mem) \
+                                          MEMB_FAST_INIT(name) \
+                                          MEMB_STATS_INIT(name)}
 
 struct memb {
   unsigned short size;
   unsigned short num;
   char *count;
   void *mem;
+#if MEMB_FAST
+  /* Stack of the indices of the freed blocks. */
+  unsigned short *free;
+  /* Position of a freed block in the stack of freed blocks. */
+  unsigned short *pos;
+  /* Number of entries in the stack of freed blocks. */
+  unsigned short nfree;
+  /* Blocks from this index on have never been allocated. */
+  unsigned short next;
+#endif /* MEMB_FAST */
+#if MEMB_STATS
+  /* Name of the memory block. */
+  const char *name;
+  /* Next memory block in the registry. */
+  struct memb *reg_next;
+  /* Number of allocated blocks. */
+  unsigned short used;
+  /* Peak number of allocated blocks. */
+  unsigned short peak;
+  /* Number of failed allocations. */
+  unsigned short fails;
+  /* Set once the memory block is in the registry. */
+  unsigned char registered;
+#endif /* MEMB_STATS */
 };
 
 /**
@@ -160,6 +235,29 @@ int memb_inmemb(struct memb *m, void *ptr);
 
 int  memb_numfree(struct memb *m);
 
+#if MEMB_STATS
+/**
+ * Get the memory blocks in the registry.
+ * \return The first registered memory block, the next one is linked by
+ * its reg_next member.
+ */
+struct memb *memb_stats_list(void);
+
+/**
+ * Print the use of all registered memory blocks as a table.
+ * \param buf Buffer to print to.
+ * \param len Size of the buffer.
+ * \return Number of characters printed, as returned by snprintf().
+ */
+int  memb_stats_print(char *buf, int len);
+
+/**
+ * Restart the peak use and failure tracking of all registered memory
+ * blocks.
+ */
+void memb_stats_reset(void);
+#endif /* MEMB_STATS */
+
 /** @} */
 /** @} */
 /** @} */
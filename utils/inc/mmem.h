@@ -63,6 +63,26 @@
 #ifndef MMEM_H_
 #define MMEM_H_
 
+/**
+ * Use segregated size classes instead of compacting on every free.
+ *
+ * If MMEM_CONF_SEGREGATED is set, allocations are rounded up to power
+ * of two size classes. Freed blocks are kept in a free list per class,
+ * hence mmem_alloc() and mmem_free() take constant time and never move
+ * memory. Requests beyond the largest class, or whose class does not fit
+ * anymore, get a block of their exact size. The memory parked in the free
+ * lists is reclaimed by mmem_compact(), which should be called when the
+ * system is idle. An allocation that only fails because of parked memory
+ * compacts at once. Every block carries a header of two pointers at most,
+ * so slightly less payload fits into MMEM_CONF_SIZE than with the
+ * compacting allocator.
+ */
+#ifdef MMEM_CONF_SEGREGATED
+#define MMEM_SEGREGATED MMEM_CONF_SEGREGATED
+#else
+#define MMEM_SEGREGATED 0
+#endif /* MMEM_CONF_SEGREGATED */
+
 /*---------------------------------------------------------------------------*/
 /**
  * \brief      Get a pointer to the managed memory
@@ -90,6 +110,9 @@ struct mmem {
 int  mmem_alloc(struct mmem *m, unsigned int size);
 void mmem_free(struct mmem *);
 void mmem_init(void);
+#if MMEM_SEGREGATED
+void mmem_compact(void);
+#endif /* MMEM_SEGREGATED */
 
 #endif /* MMEM_H_ */
 
@@ -331,6 +331,59 @@ void              packetbuf_attr_copyto(struct packetbuf_attr *attrs,
 void              packetbuf_attr_copyfrom(struct packetbuf_attr *attrs,
                     struct packetbuf_addr *addrs);
 
+/**
+ * \brief      Store the attributes of queued packets in packed form
+ *
+ *             If PACKETBUF_CONF_ATTRS_PACKED is set, only the non-zero
+ *             attributes are stored with a packet, preceded by a bitmap
+ *             of their types. PACKETBUF_ATTRS_PACKED_NUM is the number of
+ *             attributes that can be stored per packet.
+ */
+#ifdef PACKETBUF_CONF_ATTRS_PACKED
+#define PACKETBUF_ATTRS_PACKED PACKETBUF_CONF_ATTRS_PACKED
+#else
+#define PACKETBUF_ATTRS_PACKED 0
+#endif
+
+#if PACKETBUF_ATTRS_PACKED
+#ifdef PACKETBUF_CONF_ATTRS_PACKED_NUM
+#define PACKETBUF_ATTRS_PACKED_NUM PACKETBUF_CONF_ATTRS_PACKED_NUM
+#else
+#define PACKETBUF_ATTRS_PACKED_NUM 8
+#endif
+
+struct packetbuf_attrs_packed {
+  /** Bitmap of the attributes that are stored */
+  uint32_t types;
+  /** Values of the stored attributes, in the order of their types */
+  packetbuf_attr_t val[PACKETBUF_ATTRS_PACKED_NUM];
+  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+};
+
+/**
+ * \brief      Pack the attributes of the packetbuf
+ * \param p    The packed attributes
+ * \retval 0   iff there are more attributes than can be stored, p is
+ *             left unchanged then
+ */
+int               packetbuf_attr_pack(struct packetbuf_attrs_packed *p);
+
+/**
+ * \brief      Restore the attributes of the packetbuf from packed form
+ * \param p    The packed attributes
+ */
+void              packetbuf_attr_unpack(const struct packetbuf_attrs_packed *p);
+
+/**
+ * \brief      Get an attribute from packed form
+ * \param p    The packed attributes
+ * \param type The type of the attribute
+ * \return     The value of the attribute, zero if it is not stored
+ */
+packetbuf_attr_t  packetbuf_attr_packed(const struct packetbuf_attrs_packed *p,
+                    uint8_t type);
+#endif /* PACKETBUF_ATTRS_PACKED */
+
 #define PACKETBUF_ATTRIBUTES(...) { __VA_ARGS__ PACKETBUF_ATTR_LAST }
 #define PACKETBUF_ATTR_LAST { PACKETBUF_ATTR_NONE, 0 }
 
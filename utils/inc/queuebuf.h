@@ -87,6 +87,30 @@
 #define QUEUEBUF_DEBUG 0
 #endif /* QUEUEBUF_CONF_DEBUG */
 
+/* If QUEUEBUF_CONF_REF is set, the payload of a queuebuf is reference
+   counted. queuebuf_clone() then returns a new queuebuf that shares the
+   payload of an existing one, so that the same frame can sit in several
+   queues while it is stored only once. QUEUEBUF_NUM is the number of
+   queuebufs and QUEUEBUF_DATA_NUM the number of distinct payloads. A
+   shared payload is copied before it is updated from the packetbuf, but
+   writes through queuebuf_dataptr() are seen by all clones. */
+#ifdef QUEUEBUF_CONF_REF
+#define QUEUEBUF_REF QUEUEBUF_CONF_REF
+#else /* QUEUEBUF_CONF_REF */
+#define QUEUEBUF_REF 0
+#endif /* QUEUEBUF_CONF_REF */
+
+#if QUEUEBUF_REF
+  #if WITH_SWAP
+    #error "QUEUEBUF_CONF_REF cannot be used with swapping"
+  #endif
+  #ifdef QUEUEBUF_CONF_DATA_NUM
+    #define QUEUEBUF_DATA_NUM QUEUEBUF_CONF_DATA_NUM
+  #else
+    #define QUEUEBUF_DATA_NUM QUEUEBUF_NUM
+  #endif
+#endif /* QUEUEBUF_REF */
+
 struct queuebuf;
 
 void queuebuf_init(void);
@@ -97,8 +121,13 @@ struct queuebuf *queuebuf_new_from_packetbuf_debug(const char *file, int line);
 #else /* QUEUEBUF_DEBUG */
 struct queuebuf *queuebuf_new_from_packetbuf(void);
 #endif /* QUEUEBUF_DEBUG */
-void queuebuf_update_attr_from_packetbuf(struct queuebuf *b);
-void queuebuf_update_from_packetbuf(struct queuebuf *b);
+#if QUEUEBUF_REF
+struct queuebuf *queuebuf_clone(struct queuebuf *b);
+#endif /* QUEUEBUF_REF */
+/* The update functions return 0 and leave the queuebuf unchanged if the
+   attributes of the packetbuf cannot be stored. */
+int queuebuf_update_attr_from_packetbuf(struct queuebuf *b);
+int queuebuf_update_from_packetbuf(struct queuebuf *b);
 
 void queuebuf_to_packetbuf(struct queuebuf *b);
 void queuebuf_free(struct queuebuf *b);
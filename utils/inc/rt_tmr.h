@@ -66,12 +66,31 @@ typedef uint32_t rt_tmr_qty_t;
 
 typedef void (*pf_cb_void_t)(void*);
 
+/*
+ * Use a binary min-heap instead of the sorted double-linked list to store
+ * the running timers. Starting and stopping a timer then costs O(log n)
+ * instead of O(n). RT_TMR_CFG_HEAP_SIZE limits the number of running timers,
+ * rt_tmr_start() fails with E_RT_TMR_ERR_FULL if no more timer fits.
+ */
+#ifndef RT_TMR_CFG_HEAP_EN
+#define RT_TMR_CFG_HEAP_EN                                     ( 0u )
+#endif
+
+#ifndef RT_TMR_CFG_HEAP_SIZE
+#define RT_TMR_CFG_HEAP_SIZE                                   ( 32u )
+#endif
+
 
 typedef enum {
   E_RT_TMR_TYPE_ONE_SHOT,
   E_RT_TMR_TYPE_PERIODIC
 } e_rt_tmr_type_t;
 
+typedef enum {
+  E_RT_TMR_ERR_NONE,
+  E_RT_TMR_ERR_FULL,
+} e_rt_tmr_err_t;
+
 typedef enum {
   E_RT_TMR_STATE_INIT,
   E_RT_TMR_STATE_CREATED,
@@ -91,6 +110,9 @@ struct s_rt_tmr {
   e_rt_tmr_state_t   state;
   pf_cb_void_t       cbFnct;
   void              *cbArg;
+#if (RT_TMR_CFG_HEAP_EN > 0u)
+  rt_tmr_qty_t       heapIx;
+#endif
 };
 
 /*
@@ -122,11 +144,13 @@ extern rt_tmr_qty_t     TmrListQty;
 void rt_tmr_init(void);
 void rt_tmr_create(s_rt_tmr_t *p_tmr, e_rt_tmr_type_t type, rt_tmr_tick_t period, pf_cb_void_t fnct, void *p_cb);
 void rt_tmr_stop(s_rt_tmr_t *p_tmr);
-void rt_tmr_start(s_rt_tmr_t *p_tmr);
+e_rt_tmr_err_t rt_tmr_start(s_rt_tmr_t *p_tmr);
 void rt_tmr_delay(rt_tmr_tick_t delay);
 void rt_tmr_update(void);
+rt_tmr_tick_t rt_tmr_advance(rt_tmr_tick_t ticks);
 rt_tmr_tick_t rt_tmr_getCurrenTick(void);
 rt_tmr_tick_t rt_tmr_getRemain(s_rt_tmr_t *p_tmr);
+s_rt_tmr_t *rt_tmr_getNext(void);
 e_rt_tmr_state_t rt_tmr_getState(s_rt_tmr_t *p_tmr);
 
 #endif /* RT_TMR_PRESENT */
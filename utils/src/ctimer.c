@@ -65,7 +65,6 @@
 #include "evproc.h"
 #include "ctimer.h"
 #include "timer.h"
-#include "clist.h"
 
 
 #define LOGGER_ENABLE                   LOGGER_CTIMER
@@ -73,18 +72,19 @@
 #include "logger.h"
 
 /*
- *  --- Local Variables ---------------------------------------------------- *
+ * --- Macro Definitions --------------------------------------------------- *
  */
 
-/** List for the callback timer. */
-LIST(gp_ctimList);
+/** Get the callback timer the given event timer is embedded in */
+#define CTIMER_FROM_ETIMER( p_et )      \
+    ( (struct ctimer*)((uint8_t*)(p_et) - offsetof(struct ctimer, etimer)) )
 
 
 /*
  *  --- Local Function Prototypes ------------------------------------------ *
  */
 
-/* Refresh the callback timer list. For further declaration please
+/* Handle the expiration of a callback timer. For further declaration please
  * refer to the function definition */
 static void _ctimer_refresh( c_event_t event, void* data );
 
@@ -94,35 +94,34 @@ static void _ctimer_refresh( c_event_t event, void* data );
  */
 
 /**
- * \brief   Refresh the callback timer list.
+ * \brief   Handle the expiration of a callback timer.
  *
- *          This function iterates through the list of registered
- *          callback timers and checks if they expired. If yes
- *          the according callback will be called.
- *          This function is given to the event timer as callback. It compares
- *          the event timer structures given as parameter of the callback to identify
- *          which of the callback timer expired actually.
+ *          This function is given to the event timer as callback. The
+ *          callback timer is resolved from the embedded event timer that
+ *          is given as parameter. If the callback timer is still pending
+ *          the according callback will be called. A callback timer that
+ *          was stopped or set again after its event timer expired is
+ *          ignored.
  *
  * \param   event   New event
- * \param   data    Pointer to the data
+ * \param   data    Pointer to the expired event timer
  *
  */
 void _ctimer_refresh( c_event_t event, void* data )
 {
     struct ctimer *pst_cTim;
 
-    for( pst_cTim = list_head(gp_ctimList); pst_cTim != NULL;
-            pst_cTim = pst_cTim->next )
+    if( (event != EVENT_TYPE_TIMER_EXP) || (data == NULL) )
+        return;
+
+    pst_cTim = CTIMER_FROM_ETIMER( data );
+    if( pst_cTim->pending && etimer_expired( &pst_cTim->etimer ) )
     {
-      if( &pst_cTim->etimer == data )
-      {
-          list_remove( gp_ctimList, pst_cTim );
-          if( pst_cTim->f != NULL )
-          {
-              pst_cTim->f( pst_cTim->ptr );
-          }
-          break;
-      }
+        pst_cTim->pending = FALSE;
+        if( pst_cTim->f != NULL )
+        {
+            pst_cTim->f( pst_cTim->ptr );
+        }
     }
 }
 
@@ -137,8 +136,8 @@ void _ctimer_refresh( c_event_t event, void* data )
 */
 void ctimer_init( void )
 {
-    /* initialize timer list */
-    list_init( gp_ctimList );
+    /* Nothing to do. Pending callback timers are dropped together with
+     * their event timers by etimer_init(). */
 
 } /* ctimer_init() */
 
@@ -154,9 +153,9 @@ void ctimer_set( struct ctimer* c, clock_time_t t,
     c->f = f;
     c->ptr = ptr;
 
-    /* set the associated etimer and add the timer to the list */
+    /* set the associated etimer */
     etimer_set( &c->etimer, t, _ctimer_refresh );
-    list_add( gp_ctimList, c );
+    c->pending = TRUE;
 
 } /* ctimer_set() */
 
@@ -167,9 +166,9 @@ void ctimer_set( struct ctimer* c, clock_time_t t,
 */
 void ctimer_stop( struct ctimer* pst_stopTim )
 {
-    /* Stop the timer and remove it from the list */
+    /* Stop the timer */
     etimer_stop( &pst_stopTim->etimer );
-    list_remove( gp_ctimList, pst_stopTim );
+    pst_stopTim->pending = FALSE;
 
 } /* ctimer_stop() */
 
@@ -182,10 +181,7 @@ void ctimer_reset( struct ctimer* c )
 {
   /* Reset the timer.*/
   etimer_reset( &c->etimer );
-
-  /* Put timer to the end of the list */
-  list_remove( gp_ctimList, c );
-  list_add( gp_ctimList, c );
+  c->pending = TRUE;
 
 } /* ctimer_reset() */
 
@@ -198,10 +194,7 @@ void ctimer_restart( struct ctimer* c )
 {
   /* Restart the timer */
   etimer_restart( &c->etimer );
-
-  /* Put timer to the end of the list */
-  list_remove( gp_ctimList, c );
-  list_add( gp_ctimList, c );
+  c->pending = TRUE;
 
 } /* ctimer_restart() */
 
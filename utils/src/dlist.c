@@ -0,0 +1,303 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \addtogroup dlist
+ * @{
+ */
+
+/**
+ * \file
+ * Double linked list library implementation.
+ */
+
+#include "dlist.h"
+
+#ifndef NULL
+#define NULL 0
+#endif
+
+struct dlist_item {
+  struct dlist_item *next;
+  struct dlist_item *prev;
+};
+
+/*---------------------------------------------------------------------------*/
+/* Check whether an element with valid links is on the list. */
+static int
+dlist_contains(dlist_t list, struct dlist_item *item)
+{
+  return (item->prev != NULL) || (list->head == item);
+}
+/*---------------------------------------------------------------------------*/
+/* Unlink an element that is on the list. */
+static void
+dlist_unlink(dlist_t list, struct dlist_item *item)
+{
+  if(item->prev == NULL) {
+    list->head = item->next;
+  } else {
+    item->prev->next = item->next;
+  }
+  if(item->next == NULL) {
+    list->tail = item->prev;
+  } else {
+    item->next->prev = item->prev;
+  }
+  item->next = NULL;
+  item->prev = NULL;
+  list->len--;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Initialize a double linked list.
+ *
+ * \param list The list to be initialized.
+ */
+void
+dlist_init(dlist_t list)
+{
+  list->head = NULL;
+  list->tail = NULL;
+  list->len = 0;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get a pointer to the first element of a list.
+ *
+ * \param list The list.
+ * \return A pointer to the first element on the list.
+ */
+void *
+dlist_head(dlist_t list)
+{
+  return list->head;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get a pointer to the last element of a list.
+ *
+ * \param list The list.
+ * \return A pointer to the last element on the list.
+ */
+void *
+dlist_tail(dlist_t list)
+{
+  return list->tail;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Add an item at the end of a list.
+ *
+ * An item that is already on the list is moved to its end.
+ *
+ * \param list The list.
+ * \param item A pointer to the item to be added.
+ */
+void
+dlist_add(dlist_t list, void *item)
+{
+  struct dlist_item *i = item;
+
+  if(dlist_contains(list, i)) {
+    dlist_unlink(list, i);
+  }
+
+  i->next = NULL;
+  i->prev = list->tail;
+  if(list->tail == NULL) {
+    list->head = i;
+  } else {
+    ((struct dlist_item *)list->tail)->next = i;
+  }
+  list->tail = i;
+  list->len++;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Add an item to the start of the list.
+ *
+ * An item that is already on the list is moved to its start.
+ *
+ * \param list The list.
+ * \param item A pointer to the item to be added.
+ */
+void
+dlist_push(dlist_t list, void *item)
+{
+  struct dlist_item *i = item;
+
+  if(dlist_contains(list, i)) {
+    dlist_unlink(list, i);
+  }
+
+  i->prev = NULL;
+  i->next = list->head;
+  if(list->head == NULL) {
+    list->tail = i;
+  } else {
+    ((struct dlist_item *)list->head)->prev = i;
+  }
+  list->head = i;
+  list->len++;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove the last object on the list.
+ *
+ * \param list The list
+ * \return The removed object
+ */
+void *
+dlist_chop(dlist_t list)
+{
+  struct dlist_item *i = list->tail;
+
+  if(i != NULL) {
+    dlist_unlink(list, i);
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove the first object on a list.
+ *
+ * \param list The list.
+ * \return Pointer to the removed element of list.
+ */
+void *
+dlist_pop(dlist_t list)
+{
+  struct dlist_item *i = list->head;
+
+  if(i != NULL) {
+    dlist_unlink(list, i);
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove a specific element from a list.
+ *
+ * Removing an item that is not on the list has no effect.
+ *
+ * \param list The list.
+ * \param item The item that is to be removed from the list.
+ */
+void
+dlist_remove(dlist_t list, void *item)
+{
+  struct dlist_item *i = item;
+
+  if(dlist_contains(list, i)) {
+    dlist_unlink(list, i);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get the length of a list.
+ *
+ * \param list The list.
+ * \return The length of the list.
+ */
+int
+dlist_length(dlist_t list)
+{
+  return list->len;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Insert an item after a specified item on the list
+ * \param list The list
+ * \param previtem The item after which the new item should be inserted
+ * \param newitem  The new item that is to be inserted
+ *
+ *             If previtem is NULL, the new item is placed at the
+ *             start of the list.
+ */
+void
+dlist_insert(dlist_t list, void *previtem, void *newitem)
+{
+  struct dlist_item *p = previtem;
+  struct dlist_item *n = newitem;
+
+  if(dlist_contains(list, n)) {
+    dlist_unlink(list, n);
+  }
+
+  if(p == NULL) {
+    dlist_push(list, n);
+  } else if(p == list->tail) {
+    dlist_add(list, n);
+  } else {
+    n->prev = p;
+    n->next = p->next;
+    p->next->prev = n;
+    p->next = n;
+    list->len++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Clear the links of an item
+ * \param item An item that is not on a list
+ *
+ *             This function must be called for an item taken from
+ *             uninitialized memory before it is added to a list.
+ */
+void
+dlist_item_init(void *item)
+{
+  ((struct dlist_item *)item)->next = NULL;
+  ((struct dlist_item *)item)->prev = NULL;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Get the item preceding this item
+ * \param item A list item
+ * \returns    The previous item on the list or NULL
+ */
+void *
+dlist_item_prev(void *item)
+{
+  return item == NULL ? NULL : ((struct dlist_item *)item)->prev;
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
@@ -64,6 +64,9 @@
 #include "emb6.h"
 #include "etimer.h"
 #include "clist.h"
+#if ( ETIMER_STATS == TRUE )
+#include "bsp.h"
+#endif /* #if ( ETIMER_STATS == TRUE ) */
 
 #define LOGGER_ENABLE                   LOGGER_ETIMER
 #define LOGGER_SUBSYSTEM                "etim"
@@ -74,6 +77,13 @@
  * --- Macro Definitions --------------------------------------------------- *
  */
 
+#if ( ETIMER_STATS == TRUE )
+/** Account an expired timer */
+#define ETIMER_STAT_FIRED( p_et, res )  _etimer_statFired( (p_et), (res) )
+#else
+#define ETIMER_STAT_FIRED( p_et, res )  (void)(res)
+#endif /* #if ( ETIMER_STATS == TRUE ) */
+
 /** Shall the timer list be printed if debug is enabled */
 #define ETIMER_PRINT_LIST               FALSE
 
@@ -85,12 +95,44 @@
 #define ETIMER_PRINT_LIST()
 #endif /* #if ( (LOGGER_ENABLE == TRUE) && (ETIMER_PRINT_LIST == TRUE) ) */
 
+#if ( ETIMER_HEAP == TRUE )
+/** Expiration time of a timer */
+#define ETIMER_EXP_TIME( p_et )         ( (p_et)->timer.start + (p_et)->timer.interval )
+
+/** Check if timer a expires before timer b (overflow safe) */
+#define ETIMER_EXP_BEFORE( p_a, p_b )   \
+    ( (int32_t)(ETIMER_EXP_TIME(p_a) - ETIMER_EXP_TIME(p_b)) < 0 )
+#endif /* #if ( ETIMER_HEAP == TRUE ) */
+
 /*
  *  --- Local Variables ---------------------------------------------------- *
  */
 
+#if ( ETIMER_HEAP == TRUE )
+/** Heap position of a timer in the overflow list */
+#define ETIMER_IDX_OVERFLOW             0xFFFFU
+
+#if ( ETIMER_HEAP_SIZE >= ETIMER_IDX_OVERFLOW )
+#error "ETIMER_HEAP_SIZE is too large"
+#endif
+
+/** Binary min-heap of the active event timers ordered by expiration time. */
+static struct etimer* gp_etimHeap[ETIMER_HEAP_SIZE];
+
+/** Number of timers in the heap. */
+static uint16_t gi_etimHeapLen;
+
+/** List of the active event timers that did not fit into the heap. */
+LIST(gp_etimOverflow);
+#else
 /** List for the event timer. */
 LIST(gp_etimList);
+#endif /* #if ( ETIMER_HEAP == TRUE ) */
+
+#if ( ETIMER_STATS == TRUE )
+/** Runtime statistics */
+static st_etimerStats_t s_stats;
+#endif /* #if ( ETIMER_STATS == TRUE ) */
 
 /*
  *  --- Local Function Prototypes ------------------------------------------ *
@@ -100,6 +142,34 @@ LIST(gp_etimList);
  * refer to the function definition */
 static void _etimer_addTimer( struct etimer *pst_timer );
 
+/* Remove a timer from the list. For further declaration please
+ * refer to the function definition */
+static void _etimer_removeTimer( struct etimer *pst_timer );
+
+#if ( ETIMER_HEAP == TRUE )
+/* Move a timer towards the root of the heap. For further declaration please
+ * refer to the function definition */
+static void _etimer_heapUp( uint16_t i_idx );
+
+/* Move a timer towards the leaves of the heap. For further declaration
+ * please refer to the function definition */
+static void _etimer_heapDown( uint16_t i_idx );
+
+/* Check if a timer is stored in the heap. For further declaration please
+ * refer to the function definition */
+static uint8_t _etimer_inHeap( struct etimer *pst_timer );
+
+/* Insert a timer into the heap. For further information please refer to
+ * the function definition. */
+static void _etimer_heapInsert( struct etimer *pst_timer );
+#endif /* #if ( ETIMER_HEAP == TRUE ) */
+
+#if ( ETIMER_STATS == TRUE )
+/* Account an expired timer. */
+static void _etimer_statFired( struct etimer *pst_timer,
+        en_evprocResCode_t e_res );
+#endif /* #if ( ETIMER_STATS == TRUE ) */
+
 #if LOGGER_ENABLE == TRUE
 /* Print timer list. For further declaration please
  * refer to the function definition */
@@ -107,22 +177,216 @@ static void _etimer_print_list( void );
 #endif /* #if LOGGER_ENABLE == TRUE */
 
 
+#if ( ETIMER_HEAP == TRUE )
+/**
+ * \brief   Move a timer towards the root of the heap.
+ *
+ *          The timer is swapped with its parent as long as it expires
+ *          before its parent.
+ *
+ * \param   i_idx   Heap index of the timer to move.
+ */
+static void _etimer_heapUp( uint16_t i_idx )
+{
+    struct etimer* pst_tim = gp_etimHeap[i_idx];
+    uint16_t i_parent;
+
+    while( i_idx > 0 )
+    {
+        i_parent = (i_idx - 1) / 2;
+        if( !ETIMER_EXP_BEFORE( pst_tim, gp_etimHeap[i_parent] ) )
+            break;
+
+        gp_etimHeap[i_idx] = gp_etimHeap[i_parent];
+        gp_etimHeap[i_idx]->heapIdx = i_idx;
+        i_idx = i_parent;
+    }
+    gp_etimHeap[i_idx] = pst_tim;
+    pst_tim->heapIdx = i_idx;
+}
+
+
+/**
+ * \brief   Move a timer towards the leaves of the heap.
+ *
+ *          The timer is swapped with its earlier expiring child as long
+ *          as this child expires before the timer.
+ *
+ * \param   i_idx   Heap index of the timer to move.
+ */
+static void _etimer_heapDown( uint16_t i_idx )
+{
+    struct etimer* pst_tim = gp_etimHeap[i_idx];
+    uint16_t i_child;
+
+    while( (i_child = 2 * i_idx + 1) < gi_etimHeapLen )
+    {
+        if( ((i_child + 1) < gi_etimHeapLen) &&
+            ETIMER_EXP_BEFORE( gp_etimHeap[i_child + 1], gp_etimHeap[i_child] ) )
+            i_child++;
+
+        if( !ETIMER_EXP_BEFORE( gp_etimHeap[i_child], pst_tim ) )
+            break;
+
+        gp_etimHeap[i_idx] = gp_etimHeap[i_child];
+        gp_etimHeap[i_idx]->heapIdx = i_idx;
+        i_idx = i_child;
+    }
+    gp_etimHeap[i_idx] = pst_tim;
+    pst_tim->heapIdx = i_idx;
+}
+
+
+/**
+ * \brief   Check if a timer is stored in the heap.
+ *
+ *          The active flag is not sufficient since timers that were
+ *          never set may contain arbitrary values.
+ *
+ * \param   pst_timer   Pointer to the timer to check.
+ *
+ * \return  1 if the timer is in the heap, 0 otherwise.
+ */
+static uint8_t _etimer_inHeap( struct etimer *pst_timer )
+{
+    return (pst_timer->heapIdx < gi_etimHeapLen) &&
+           (gp_etimHeap[pst_timer->heapIdx] == pst_timer);
+}
+
+
+/**
+ * \brief   Insert a timer into the heap.
+ *
+ *          The heap must have room for the timer.
+ *
+ * \param   pst_timer   Pointer to a timer to be inserted.
+ */
+static void _etimer_heapInsert( struct etimer *pst_timer )
+{
+    gp_etimHeap[gi_etimHeapLen] = pst_timer;
+    pst_timer->heapIdx = gi_etimHeapLen++;
+    _etimer_heapUp( pst_timer->heapIdx );
+}
+#endif /* #if ( ETIMER_HEAP == TRUE ) */
+
+
+#if ( ETIMER_STATS == TRUE )
+/**
+ * \brief   Account an expired timer.
+ *
+ * \param   pst_timer   Pointer to the expired timer.
+ * \param   e_res       Result of queuing the expiration event.
+ */
+static void _etimer_statFired( struct etimer *pst_timer,
+        en_evprocResCode_t e_res )
+{
+    clock_time_t l_late = bsp_getTick() - etimer_expiration_time( pst_timer );
+
+    /* an expired timer is never early, guard against a wrapped subtraction */
+    if( (int32_t)l_late < 0 )
+        l_late = 0;
+
+    s_stats.l_fired++;
+    s_stats.l_latenessSum += l_late;
+    if( l_late > s_stats.l_latenessMax )
+        s_stats.l_latenessMax = l_late;
+    if( e_res != E_SUCCESS )
+        s_stats.l_lost++;
+}
+#endif /* #if ( ETIMER_STATS == TRUE ) */
+
+
 /**
  * \brief   Add timer to the timer list.
  *
  *          This function adds a new timer to the list. In case the timer
  *          already exists it will be removed and put to the end of the list.
+ *          If the heap is used the timer is (re-)sorted by its expiration
+ *          time instead.
  *
  * \param   pst_timer   Pointer to a timer to be added.
  */
 static void _etimer_addTimer( struct etimer *pst_timer )
 {
+#if ( ETIMER_HEAP == TRUE )
+    if( _etimer_inHeap( pst_timer ) )
+    {
+        /* the expiration time might have moved in both directions */
+        _etimer_heapUp( pst_timer->heapIdx );
+        _etimer_heapDown( pst_timer->heapIdx );
+    }
+    else if( pst_timer->heapIdx == ETIMER_IDX_OVERFLOW )
+    {
+        /* already in the overflow list, which is not ordered */
+        list_add( gp_etimOverflow, pst_timer );
+    }
+    else if( gi_etimHeapLen < ETIMER_HEAP_SIZE )
+    {
+        _etimer_heapInsert( pst_timer );
+    }
+    else
+    {
+        /* The timer must not get lost. It is kept in the overflow list
+         * until the heap has room for it. */
+        LOG_WARN("heap full, timer %p overflows (%d)\n\r", pst_timer, ETIMER_HEAP_SIZE);
+#if ( ETIMER_STATS == TRUE )
+        s_stats.l_overflow++;
+#endif /* #if ( ETIMER_STATS == TRUE ) */
+        pst_timer->heapIdx = ETIMER_IDX_OVERFLOW;
+        list_add( gp_etimOverflow, pst_timer );
+    }
+#else
     list_remove(gp_etimList, pst_timer);
     list_add(gp_etimList, pst_timer);
+#endif /* #if ( ETIMER_HEAP == TRUE ) */
     pst_timer->active = TMR_ACTIVE;
 }
 
 
+/**
+ * \brief   Remove timer from the timer list.
+ *
+ * \param   pst_timer   Pointer to a timer to be removed.
+ */
+static void _etimer_removeTimer( struct etimer *pst_timer )
+{
+#if ( ETIMER_HEAP == TRUE )
+    uint16_t i_idx;
+    struct etimer* pst_over;
+
+    if( _etimer_inHeap( pst_timer ) )
+    {
+        /* fill the gap with the last timer of the heap */
+        i_idx = pst_timer->heapIdx;
+        gi_etimHeapLen--;
+        if( i_idx < gi_etimHeapLen )
+        {
+            gp_etimHeap[i_idx] = gp_etimHeap[gi_etimHeapLen];
+            gp_etimHeap[i_idx]->heapIdx = i_idx;
+            _etimer_heapUp( i_idx );
+            _etimer_heapDown( i_idx );
+        }
+        gp_etimHeap[gi_etimHeapLen] = NULL;
+
+        /* the heap has room for a timer of the overflow list */
+        pst_over = list_pop( gp_etimOverflow );
+        if( pst_over != NULL )
+        {
+            _etimer_heapInsert( pst_over );
+        }
+    }
+    else if( pst_timer->heapIdx == ETIMER_IDX_OVERFLOW )
+    {
+        list_remove( gp_etimOverflow, pst_timer );
+    }
+    pst_timer->heapIdx = 0;
+#else
+    list_remove( gp_etimList, pst_timer );
+#endif /* #if ( ETIMER_HEAP == TRUE ) */
+    pst_timer->active = TMR_NOT_ACTIVE;
+}
+
+
 #if LOGGER_ENABLE == TRUE
 /**
  * \brief   Print list of timers.
@@ -133,13 +397,20 @@ static void _etimer_addTimer( struct etimer *pst_timer )
 void _etimer_print_list( void )
 {
     struct etimer * st_temp;
-    uint8_t j=0;
+    uint16_t j=0;
     LOG_INFO("%s\n\r","timer list");
+#if ( ETIMER_HEAP == TRUE )
+    for (j = 0; j < gi_etimHeapLen; j++) {
+        st_temp = gp_etimHeap[j];
+        LOG_RAW("%d | %p : %lu : %lu\n\r",j,st_temp,st_temp->timer.start,st_temp->timer.interval);
+    }
+#else
     for (st_temp = list_head(gp_etimList); \
         st_temp != NULL; \
         st_temp = list_item_next(st_temp), j++) {
         LOG_RAW("%d | %p : %p : %lu : %lu\n\r",j,st_temp,st_temp->next,st_temp->timer.start,st_temp->timer.interval);
     }
+#endif /* #if ( ETIMER_HEAP == TRUE ) */
 }
 #endif /* #if LOGGER_ENABLE == TRUE */
 
@@ -153,8 +424,25 @@ void _etimer_print_list( void )
 */
 void etimer_init(void)
 {
+#if ( ETIMER_HEAP == TRUE )
+    uint16_t i;
+
+    /* mark all timers still in the heap as stopped and clear the heap */
+    for( i = 0; i < gi_etimHeapLen; i++ )
+    {
+        gp_etimHeap[i]->active = TMR_NOT_ACTIVE;
+        gp_etimHeap[i] = NULL;
+    }
+    gi_etimHeapLen = 0;
+    list_init( gp_etimOverflow );
+#else
     /* initialize list */
     list_init(gp_etimList);
+#endif /* #if ( ETIMER_HEAP == TRUE ) */
+
+#if ( ETIMER_STATS == TRUE )
+    memset( &s_stats, 0, sizeof(s_stats) );
+#endif /* #if ( ETIMER_STATS == TRUE ) */
 
 } /* etimer_init */
 
@@ -165,6 +453,41 @@ void etimer_init(void)
 */
 void etimer_request_poll(void)
 {
+    en_evprocResCode_t e_res;
+#if ( ETIMER_HEAP == TRUE )
+    struct etimer* pst_tTim;
+    struct etimer* pst_nTim;
+
+    /* Only the timer with the earliest expiration time has to be checked.
+     * If it has not expired yet no other timer has expired either. */
+    while( (gi_etimHeapLen > 0) && timer_expired( &gp_etimHeap[0]->timer ) )
+    {
+        pst_tTim = gp_etimHeap[0];
+        LOG_INFO("delete %p from heap\n\r",pst_tTim);
+        ETIMER_PRINT_LIST();
+
+        /* Remove the timer and generate timer expired event */
+        _etimer_removeTimer( pst_tTim );
+        e_res = evproc_putTargetEvent( E_EVPROC_TAIL, EVENT_TYPE_TIMER_EXP,
+                pst_tTim, pst_tTim->callback );
+        ETIMER_STAT_FIRED( pst_tTim, e_res );
+    }
+
+    /* the timers of the overflow list are not ordered */
+    for( pst_tTim = list_head( gp_etimOverflow ); pst_tTim != NULL;
+         pst_tTim = pst_nTim )
+    {
+        pst_nTim = list_item_next( pst_tTim );
+        if( timer_expired( &pst_tTim->timer ) )
+        {
+            LOG_INFO("delete %p from overflow list\n\r",pst_tTim);
+            _etimer_removeTimer( pst_tTim );
+            e_res = evproc_putTargetEvent( E_EVPROC_TAIL, EVENT_TYPE_TIMER_EXP,
+                    pst_tTim, pst_tTim->callback );
+            ETIMER_STAT_FIRED( pst_tTim, e_res );
+        }
+    }
+#else
     struct etimer* pst_tTim = list_head(gp_etimList);
     struct etimer* pst_nTim = NULL;
 
@@ -188,15 +511,17 @@ void etimer_request_poll(void)
 
             /* Store pointer to a next timer, to check all timers in a list
              * Generate timer expired event */
-            evproc_putEvent( E_EVPROC_TAIL,EVENT_TYPE_TIMER_EXP, pst_tTim );
+            e_res = evproc_putTargetEvent( E_EVPROC_TAIL, EVENT_TYPE_TIMER_EXP,
+                    pst_tTim, pst_tTim->callback );
+            ETIMER_STAT_FIRED( pst_tTim, e_res );
 
             /* Remove matched timer from the list and set the active flag */
-            list_remove( gp_etimList, pst_tTim );
-            pst_tTim->active = TMR_NOT_ACTIVE;
+            _etimer_removeTimer( pst_tTim );
 
         }
         pst_tTim = pst_nTim;
     }
+#endif /* #if ( ETIMER_HEAP == TRUE ) */
 
 } /* etimer_request_poll() */
 
@@ -211,9 +536,10 @@ void etimer_set( struct etimer* pst_et, clock_time_t l_interval,
     /* set the underlying timer */
     timer_set(&pst_et->timer, l_interval);
 
-    /* add the timer to the list and register the callback for the timer.*/
+    /* add the timer to the list and remember the callback the expiration
+     * event is dispatched to */
+    pst_et->callback = pfn_callback;
     _etimer_addTimer( pst_et );
-    evproc_regCallback( EVENT_TYPE_TIMER_EXP, pfn_callback );
 
     LOG_INFO("add new timer %p\n\r",pst_et);
     ETIMER_PRINT_LIST();
@@ -228,8 +554,7 @@ void etimer_set( struct etimer* pst_et, clock_time_t l_interval,
 void etimer_stop( struct etimer* pst_et )
 {
     /* remove the timer from the list and stop it */
-    list_remove( gp_etimList, pst_et );
-    pst_et->active = TMR_NOT_ACTIVE;
+    _etimer_removeTimer( pst_et );
 
     LOG_INFO("stop timer %p\n\r",pst_et);
 
@@ -275,6 +600,12 @@ void etimer_adjust( struct etimer* pst_et, int32_t l_timediff )
     /* adjust the timer */
     pst_et->timer.start += l_timediff;
 
+#if ( ETIMER_HEAP == TRUE )
+    /* keep the heap sorted */
+    if( _etimer_inHeap( pst_et ) )
+        _etimer_addTimer( pst_et );
+#endif /* #if ( ETIMER_HEAP == TRUE ) */
+
     LOG_INFO("adjust timer %p\n\r",pst_et);
 
 }/* etimer_adjust() */
@@ -322,6 +653,24 @@ clock_time_t etimer_start_time(struct etimer *pst_et)
 */
 clock_time_t etimer_nextEvent(void)
 {
+#if ( ETIMER_HEAP == TRUE )
+    struct etimer* pst_tTim;
+    struct etimer* pst_nextTim;
+
+    /* the root of the heap expires first */
+    if( gi_etimHeapLen == 0 )
+        return 0;
+
+    /* unless a timer of the overflow list expires even earlier */
+    pst_nextTim = gp_etimHeap[0];
+    for( pst_tTim = list_head( gp_etimOverflow ); pst_tTim != NULL;
+         pst_tTim = list_item_next( pst_tTim ) )
+    {
+        if( ETIMER_EXP_BEFORE( pst_tTim, pst_nextTim ) )
+            pst_nextTim = pst_tTim;
+    }
+    return ETIMER_EXP_TIME( pst_nextTim );
+#else
     struct etimer* pst_tTim = list_head(gp_etimList);
     struct etimer* pst_nTim = NULL;
 
@@ -359,7 +708,31 @@ clock_time_t etimer_nextEvent(void)
     }
 
     return ct_nextExpTime;
+#endif /* #if ( ETIMER_HEAP == TRUE ) */
 
 } /* etimer_nextEvent() */
 
 
+#if ( ETIMER_STATS == TRUE )
+/*---------------------------------------------------------------------------*/
+/*
+* etimer_getStats()
+*/
+void etimer_getStats( st_etimerStats_t* ps_stats )
+{
+    if( ps_stats != NULL )
+        *ps_stats = s_stats;
+
+} /* etimer_getStats() */
+
+
+/*---------------------------------------------------------------------------*/
+/*
+* etimer_resetStats()
+*/
+void etimer_resetStats( void )
+{
+    memset( &s_stats, 0, sizeof(s_stats) );
+
+} /* etimer_resetStats() */
+#endif /* #if ( ETIMER_STATS == TRUE ) */
@@ -64,24 +64,83 @@
 #include "bsp.h"
 #include "evproc.h"
 #include "clist.h"
-#include "logger.h"
 
 #define LOGGER_ENABLE           LOGGER_EVPROC
 #include "logger.h"
 
 
+/*
+ * --- Macro Definitions --------------------------------------------------- *
+ */
+
+/** Mask to wrap an index of the event queue */
+#define EVPROC_QUEUE_MASK                   ( EVPROC_QUEUE_SIZE - 1U )
+
+#if ( (EVPROC_QUEUE_SIZE & EVPROC_QUEUE_MASK) != 0U )
+#error "EVPROC_QUEUE_SIZE must be a power of two"
+#endif
+
+/* EVPROC_QUEUE_TOTAL relies on the number of priority classes */
+typedef char evproc_prio_classes_check[(E_EVPROC_PRIO_MAX == EVPROC_PRIO_CLASSES) ? 1 : -1];
+
+/** Number of counters of the duplicate filter (power of two) */
+#define EVPROC_FILTER_SIZE                  ( 64U )
+
+/** Mask to wrap an index of the duplicate filter */
+#define EVPROC_FILTER_MASK                  ( EVPROC_FILTER_SIZE - 1U )
+
+#if (EVPROC_STATS == TRUE)
+#if ( (EVPROC_STATS_CB_MAX & (EVPROC_STATS_CB_MAX - 1U)) != 0U )
+#error "EVPROC_STATS_CB_MAX must be a power of two"
+#endif
+
+/** Time source to measure the execution time of the callbacks. The
+ * rtimer is finer than the system tick (usually 1 ms) if available. */
+#ifdef EVPROC_CONF_STATS_TIME
+#define EVPROC_STATS_TIME()                 EVPROC_CONF_STATS_TIME()
+#elif (HAL_SUPPORT_RTIMER == TRUE)
+#define EVPROC_STATS_TIME()                 ((uint32_t)bsp_rtimer_arch_now())
+#else
+#define EVPROC_STATS_TIME()                 bsp_getTick()
+#endif /* #ifdef EVPROC_CONF_STATS_TIME */
+
+/** Call a callback and account its execution time */
+#define EVPROC_CALL( pfn, ev, data )        _evproc_statCall( (pfn), (ev), (data) )
+/** Account a dispatched event */
+#define EVPROC_STAT_DISPATCH( ev )          (s_stats.pl_dispatchCnt[(ev)]++)
+/** Account a dropped event */
+#define EVPROC_STAT_DROP()                  (s_stats.l_dropCnt++)
+#else
+#define EVPROC_CALL( pfn, ev, data )        (pfn)( (ev), (data) )
+#define EVPROC_STAT_DISPATCH( ev )
+#define EVPROC_STAT_DROP()
+#endif /* #if (EVPROC_STATS == TRUE) */
+
 
 /*
  *  --- Type Definitions -----------------------------------------------------*
  */
 
+/** Type of the counters of the duplicate filter. The events of all
+ * classes can hash into the same counter. */
+#if ( EVPROC_QUEUE_TOTAL > 255U )
+typedef uint16_t evproc_filterCnt_t;
+#else
+typedef uint8_t evproc_filterCnt_t;
+#endif /* #if ( EVPROC_QUEUE_TOTAL > 255U ) */
+
 /**
  * \brief   Type of a structure to store every callback for particular event.
+ *
+ *          The registration list is indexed directly by the event type,
+ *          therefore the event type itself is not stored. The registered
+ *          callbacks are kept contiguous at the beginning of the list in
+ *          the order of their registration.
  */
 typedef struct
 {
-    /** event type */
-    c_event_t c_event;
+    /** number of registered callbacks */
+    uint8_t c_count;
 
     /** list of associated callback functions */
     pfn_callback_t pfn_callbList[MAX_CALLBACK_COUNT];
@@ -101,23 +160,104 @@ typedef struct
     /** Pointer to the event data */
     p_data_t p_data;
 
+    /** Target callback or NULL if the event is dispatched to all callbacks */
+    pfn_callback_t pfn_target;
+
 } st_eventDisc_t;
 
+
+/**
+ * \brief Type of a ring buffer to queue events.
+ *
+ *          Events can be put to both ends of the queue in constant time.
+ *          Events are always taken from the head of the queue.
+ */
+typedef struct
+{
+    /** Event storage */
+    st_eventDisc_t pst_evList[EVPROC_QUEUE_SIZE];
+
+    /** Index of the event at the head of the queue */
+    uint16_t i_head;
+
+    /** Number of queued events */
+    uint16_t i_count;
+
+    /** Maximum number of queued events */
+    uint16_t i_maxCount;
+
+} st_evQueue_t;
+
+
+/**
+ * \brief   Dispatch of an event to the registered callbacks in progress.
+ *
+ *          Dispatches nest if a callback executes an event immediately.
+ *          The frames of the dispatches in progress are chained, so that
+ *          evproc_unregCallback() can correct the position of each of them.
+ */
+typedef struct st_evprocDispatch
+{
+    /** Type of the dispatched event */
+    c_event_t c_event;
+
+    /** Index of the callback that is called currently */
+    int16_t i_idx;
+
+    /** Enclosing dispatch or NULL */
+    struct st_evprocDispatch* p_next;
+
+} st_evprocDispatch_t;
+
+
 /*
  *  --- Local Variables ---------------------------------------------------- *
  */
 
-/** Array of functions linked with every defined event */
+/** Array of functions linked with every defined event, indexed by type */
 static st_funcReg_t pst_regList[EVENT_TYPE_MAX];
 
-/** Queue of events linked with a data which is associated with this event */
-static st_eventDisc_t pst_evList[EVPROC_QUEUE_SIZE];
+/** Queues of events linked with a data which is associated with this event,
+ * one per priority class */
+static st_evQueue_t pst_evQueue[E_EVPROC_PRIO_MAX];
+
+/** Counting filter of the queued events below OBLIG_EVENT_PRIOR. A counter
+ * of zero guarantees that no such event with the according hash is queued. */
+static evproc_filterCnt_t pc_evFilter[EVPROC_FILTER_SIZE];
+
+/** Innermost dispatch in progress or NULL */
+static st_evprocDispatch_t* ps_dispatch;
 
 /** Flag to detect initialization status of the module */
 static uint8_t c_isInit = 0;
 
-/**  Queue size. */
-static uint8_t c_queueSize = 0;
+#if (EVPROC_STATS == TRUE)
+/** Runtime statistics */
+static st_evprocStats_t s_stats;
+#endif /* #if (EVPROC_STATS == TRUE) */
+
+/** Priority class of every event type */
+static const uint8_t pc_evPrio[EVENT_TYPE_MAX] =
+{
+    [EVENT_TYPE_TIMER_EXP]              = E_EVPROC_PRIO_NORMAL,
+    [EVENT_TYPE_TCP_POLL]               = E_EVPROC_PRIO_LOW,
+    [EVENT_TYPE_UDP_POLL]               = E_EVPROC_PRIO_LOW,
+    [EVENT_TYPE_PCK_INPUT]              = E_EVPROC_PRIO_NORMAL,
+    [EVENT_TYPE_ICMP6]                  = E_EVPROC_PRIO_NORMAL,
+    [EVENT_TYPE_TCPIP]                  = E_EVPROC_PRIO_NORMAL,
+    [EVENT_TYPE_SLIP_POLL]              = E_EVPROC_PRIO_NORMAL,
+    [EVENT_TYPE_APP_TX]                 = E_EVPROC_PRIO_LOW,
+    [EVENT_TYPE_MAC_ULE]                = E_EVPROC_PRIO_HIGH,
+    [EVENT_TYPE_RF]                     = E_EVPROC_PRIO_HIGH,
+    [EVENT_TYPE_TISCH_TX_RX_PENDING]    = E_EVPROC_PRIO_HIGH,
+    [EVENT_TYPE_PCK_LL]                 = E_EVPROC_PRIO_HIGH,
+    [EVENT_TYPE_REQ_INIT]               = E_EVPROC_PRIO_NORMAL,
+    [EVENT_TYPE_REQ_STOP]               = E_EVPROC_PRIO_NORMAL,
+    [EVENT_TYPE_REQ_START]              = E_EVPROC_PRIO_NORMAL,
+    [EVENT_TYPE_STATUS_CHANGE]          = E_EVPROC_PRIO_NORMAL,
+    [EVENT_TYPE_TISCH_PROCESS]          = E_EVPROC_PRIO_HIGH,
+};
+
 
 
 /*
@@ -131,11 +271,24 @@ static void _evproc_init( uint8_t first );
 /* Put new event to the queue. For further information please refer to
  * the function definition. */
 static en_evprocResCode_t _evproc_processEvent( c_event_t c_event_type,
-    p_data_t data );
+    p_data_t data, pfn_callback_t pfn_target );
 
 /* Check the queue for an event and its associated data. For further
  * Information please refer to the function definition. */
-static uint8_t _evproc_lookupEvent( c_event_t c_eventType, p_data_t p_data );
+static uint8_t _evproc_lookupEvent( c_event_t c_eventType, p_data_t p_data,
+    pfn_callback_t pfn_target );
+
+/* Calculate the duplicate filter index of an event. For further
+ * Information please refer to the function definition. */
+static uint8_t _evproc_filterIdx( c_event_t c_eventType, p_data_t p_data,
+    pfn_callback_t pfn_target );
+
+#if (EVPROC_STATS == TRUE)
+/* Call a callback and account its execution time. For further
+ * Information please refer to the function definition. */
+static void _evproc_statCall( pfn_callback_t pfn_callback,
+    c_event_t c_eventType, p_data_t p_data );
+#endif /* #if (EVPROC_STATS == TRUE) */
 
 
 
@@ -151,22 +304,33 @@ static uint8_t _evproc_lookupEvent( c_event_t c_eventType, p_data_t p_data );
  */
 static void _evproc_init( uint8_t first )
 {
-    uint8_t i,j;
+    uint16_t i;
+    uint8_t j;
 
-    /* Nullify event queue */
-    for( i = 0; i < EVPROC_QUEUE_SIZE; i++ )
+    /* Nullify event queues and the duplicate filter */
+    for( j = 0; j < E_EVPROC_PRIO_MAX; j++ )
     {
-        pst_evList[i].c_event = EVENT_TYPE_NONE;
-        pst_evList[i].p_data = NULL;
+        for( i = 0; i < EVPROC_QUEUE_SIZE; i++ )
+        {
+            pst_evQueue[j].pst_evList[i].c_event = EVENT_TYPE_NONE;
+            pst_evQueue[j].pst_evList[i].p_data = NULL;
+            pst_evQueue[j].pst_evList[i].pfn_target = NULL;
+        }
+        pst_evQueue[j].i_head = 0;
+        pst_evQueue[j].i_count = 0;
+        pst_evQueue[j].i_maxCount = 0;
     }
+    memset( pc_evFilter, 0, sizeof(pc_evFilter) );
+#if (EVPROC_STATS == TRUE)
+    memset( &s_stats, 0, sizeof(s_stats) );
+#endif /* #if (EVPROC_STATS == TRUE) */
 
     /* Assign every callback for every event by NULL pointer */
     for( i = 0; i < EVENT_TYPE_MAX; i++ )
     {
         if( (first != 0) || (i != EVENT_TYPE_STATUS_CHANGE) )
         {
-          /* Set "i" event from the list by the one from eventTypes array */
-          pst_regList[i].c_event = i;
+          pst_regList[i].c_count = 0;
           for( j=0; j<MAX_CALLBACK_COUNT; j++ )
           {
               /* Assign "j" callback from the list to NULL pointer */
@@ -183,82 +347,165 @@ static void _evproc_init( uint8_t first )
 /**
  * \brief   Process a specific event.
  *
- *          This function processes a specific event. Therefore all
+ *          This function processes a specific event. If the event carries
+ *          a target callback only this callback is called. Otherwise all
  *          registered callback functions will be called one-by-one with
  *          the associated data.
  *
  * \param   c_eventType   Type of the event to process.
  * \param   p_data        Pointer to the data associated to the callback.
+ * \param   pfn_target    Target callback or NULL for all callbacks.
  *
  * \return  Error code from according enumeration.
  */
-en_evprocResCode_t _evproc_processEvent(c_event_t c_eventType, p_data_t p_data)
+en_evprocResCode_t _evproc_processEvent( c_event_t c_eventType, p_data_t p_data,
+    pfn_callback_t pfn_target )
 {
-    uint8_t i, j;
+    st_evprocDispatch_t s_disp;
+    st_funcReg_t* pst_reg;
 
-    /*
-     * Search for a given event type and try to add given function pointer
-     * to the end of a registration list
-     */
-    for( i = 0; i < EVENT_TYPE_MAX; i++ )
+    if( c_eventType >= EVENT_TYPE_MAX )
+    {
+        LOG_ERR("unknown type (0x%04X)\n\r", c_eventType);
+        return E_UNKNOWN_TYPE;
+    }
+
+    EVPROC_STAT_DISPATCH( c_eventType );
+    if( pfn_target != NULL )
+    {
+        /* Targeted event, only the owner is interested in it */
+        EVPROC_CALL( pfn_target, c_eventType, p_data );
+        return E_SUCCESS;
+    }
+
+    /* The callbacks can (un)register callbacks of the same type, hence the
+     * count has to be evaluated in every iteration. If a callback that was
+     * already called is unregistered, evproc_unregCallback() moves the
+     * index of the dispatch back, so that no callback is skipped. */
+    pst_reg = &pst_regList[c_eventType];
+    s_disp.c_event = c_eventType;
+    s_disp.p_next = ps_dispatch;
+    ps_dispatch = &s_disp;
+    for( s_disp.i_idx = 0; s_disp.i_idx < pst_reg->c_count; s_disp.i_idx++ )
+    {
+        EVPROC_CALL( pst_reg->pfn_callbList[s_disp.i_idx], c_eventType, p_data );
+    }
+    ps_dispatch = s_disp.p_next;
+    return E_SUCCESS;
+}
+
+
+/**
+ * \brief   Calculate the duplicate filter index of an event.
+ *
+ * \param   c_eventType   Type of the event.
+ * \param   p_data        Associated data.
+ * \param   pfn_target    Associated target callback.
+ *
+ * \return  Index of the according counter of the duplicate filter.
+ */
+static uint8_t _evproc_filterIdx( c_event_t c_eventType, p_data_t p_data,
+    pfn_callback_t pfn_target )
+{
+    uintptr_t hash;
+
+    /* the lower bits of the data pointer are mostly aligned */
+    hash = ((uintptr_t)p_data >> 2) ^ ((uintptr_t)pfn_target >> 2);
+    hash ^= (hash >> 7) ^ ((uintptr_t)c_eventType * 0x9DU);
+    return (uint8_t)(hash & EVPROC_FILTER_MASK);
+}
+
+
+#if (EVPROC_STATS == TRUE)
+/**
+ * \brief   Call a callback and account its execution time.
+ *
+ *          The statistic of a callback is looked up by hashing its address
+ *          into pst_cbStat with linear probing. Calls of callbacks that do
+ *          not fit into the table anymore are only counted.
+ *
+ * \param   pfn_callback  Callback to call.
+ * \param   c_eventType   Type of the event.
+ * \param   p_data        Associated data.
+ */
+static void _evproc_statCall( pfn_callback_t pfn_callback,
+    c_event_t c_eventType, p_data_t p_data )
+{
+    uint32_t l_start;
+    uint32_t l_time;
+    uint16_t i;
+    uint16_t i_idx;
+    st_evprocCbStat_t* pst_stat = NULL;
+
+    i_idx = (uint16_t)(((uintptr_t)pfn_callback >> 2) ^
+            ((uintptr_t)pfn_callback >> 9));
+    for( i = 0; i < EVPROC_STATS_CB_MAX; i++ )
     {
-        /*
-         * Find given c_eventType in registered list. If no event matches
-         * then generate error code
-         */
-        if( pst_regList[i].c_event == c_eventType )
+        pst_stat = &s_stats.pst_cbStat[(i_idx + i) & (EVPROC_STATS_CB_MAX - 1U)];
+        if( (pst_stat->pfn_callback == pfn_callback) ||
+            (pst_stat->pfn_callback == NULL) )
         {
-            /*
-             * Event type has been found, now search for registered callback(s)
-             */
-            for( j = 0; j < MAX_CALLBACK_COUNT; j++ )
-            {
-                /*
-                 * If points to a NULL pointer end of the list has been reached
-                 */
-                if( pst_regList[i].pfn_callbList[j] == NULL )
-                {
-                    return E_SUCCESS;
-                }
-                else
-                {
-                    /*
-                     * In every other cases callback(s) should be called
-                     */
-                    pst_regList[i].pfn_callbList[j]( c_eventType, p_data );
-                }
-            }
-            return E_SUCCESS;
+            break;
         }
+        pst_stat = NULL;
     }
 
-    LOG_ERR("unknown type (0x%04X)\n\r", c_eventType);
-    return E_UNKNOWN_TYPE;
+    l_start = EVPROC_STATS_TIME();
+    pfn_callback( c_eventType, p_data );
+    l_time = EVPROC_STATS_TIME() - l_start;
+
+    if( pst_stat == NULL )
+    {
+        s_stats.l_cbUntracked++;
+        return;
+    }
+    pst_stat->pfn_callback = pfn_callback;
+    pst_stat->l_calls++;
+    pst_stat->l_timeSum += l_time;
+    if( l_time > pst_stat->l_timeMax )
+    {
+        pst_stat->l_timeMax = l_time;
+    }
 }
+#endif /* #if (EVPROC_STATS == TRUE) */
 
 
 /**
  * \brief   Find an event with its associated data.
  *
- *          This function runs through the event queue and checks if it
- *          contains a specific event with it's associated data.
+ *          This function checks if the event queue contains a specific
+ *          event with it's associated data. The queue is searched only if
+ *          the duplicate filter indicates that the event might be queued.
+ *          Only known events below OBLIG_EVENT_PRIOR can be looked up.
  *
  * \param   c_eventType   Type of the event to check for.
  * \param   p_data        Associated data to check for.
+ * \param   pfn_target    Associated target callback to check for.
  *
  * \return  0 if element was not found or 1 if it was found.
  */
-uint8_t _evproc_lookupEvent( c_event_t c_eventType, p_data_t p_data )
+uint8_t _evproc_lookupEvent( c_event_t c_eventType, p_data_t p_data,
+    pfn_callback_t pfn_target )
 {
-    uint8_t i;
-    if( c_queueSize != 0 )
+    uint16_t i;
+    st_eventDisc_t* pst_ev;
+    st_evQueue_t* pst_queue;
+
+    if( pc_evFilter[_evproc_filterIdx(c_eventType, p_data, pfn_target)] == 0 )
     {
-        for( i=0; i<c_queueSize;i++ )
-        {
-            if ((pst_evList[i].c_event == c_eventType) &&
-                (pst_evList[i].p_data == p_data))
-                return 1;
-        }
+        /* definitely not in the queue */
+        return 0;
+    }
+
+    /* an event can only be queued in the queue of its class */
+    pst_queue = &pst_evQueue[pc_evPrio[c_eventType]];
+    for( i = 0; i < pst_queue->i_count; i++ )
+    {
+        pst_ev = &pst_queue->pst_evList[(pst_queue->i_head + i) & EVPROC_QUEUE_MASK];
+        if ((pst_ev->c_event == c_eventType) &&
+            (pst_ev->p_data == p_data) &&
+            (pst_ev->pfn_target == pfn_target))
+            return 1;
     }
     return 0;
 }
@@ -287,8 +534,8 @@ void evproc_init( void )
 en_evprocResCode_t evproc_regCallback( c_event_t c_eventType,
     pfn_callback_t pfn_callback )
 {
-    uint8_t i,j;
-    uint8_t pos = MAX_CALLBACK_COUNT;
+    uint8_t j;
+    st_funcReg_t* pst_reg;
 
     /* If event process wasn't initialized before do it now. */
     if (!c_isInit)
@@ -301,62 +548,37 @@ en_evprocResCode_t evproc_regCallback( c_event_t c_eventType,
         return E_INVALID_PARAM;
     }
 
-    /* Search for a given event type and try to add given function pointer
-     * to the end of a registration list */
-    for( i = 0; i < EVENT_TYPE_MAX; i++ )
+    /* The registration list is indexed by the event type */
+    if( c_eventType >= EVENT_TYPE_MAX )
     {
-        /* Find given c_eventType in registered list. If no event matches
-         * then generate error code */
-        if( pst_regList[i].c_event == c_eventType )
-        {
-            /* Event type has been found, now search for registered callbacks */
-            for( j=0; j<MAX_CALLBACK_COUNT; j++ )
-            {
-                /* If "j" callback from registration list points to NULL
-                 * it means that end of a list has been reached. */
-                if( (pst_regList[i].pfn_callbList[j] == NULL) &&
-                    (pos == MAX_CALLBACK_COUNT) )
-                {
-                    /* empty slot found */
-                    pos = j;
-                }
-
-                /* If "j" callback is equal to a given function pointer
-                 * it means that this function for a given event has been
-                 * registered yet. */
-                if( pst_regList[i].pfn_callbList[j] == pfn_callback )
-                {
-                    LOG_ERR(" (%d) already registered\n\r",c_eventType);
-                    pos = MAX_CALLBACK_COUNT;
-                    break;
-                }
-            }
+        LOG_ERR("unknown event type (0x%02X)\n\r", c_eventType);
+        return E_UNKNOWN_TYPE;
+    }
+    pst_reg = &pst_regList[c_eventType];
 
-            if( j < MAX_CALLBACK_COUNT )
-            {
-                /* function was already registered */
-                return E_FUNC_IN_LIST;
-            }
-            else if( pos < MAX_CALLBACK_COUNT )
-            {
-                /* Given function pointer for a given event type has been added */
-                LOG_INFO("new callback for (%d) event with callback %p\n\r", c_eventType, (void*)pfn_callback);
-                pst_regList[i].pfn_callbList[pos] = pfn_callback;
-                return E_SUCCESS;
-            }
-            else
-            {
-                /* If end of the registration list has been reached and
-                 * c_callbI index are equal to a maximum allowed callbacks
-                 * generate an error. */
-                LOG_ERR("limit is reached (%d)\n\r", MAX_CALLBACK_COUNT);
-                return E_END_OF_LIST;
-            }
+    /* If "j" callback is equal to a given function pointer it means that
+     * this function for a given event has been registered yet. */
+    for( j=0; j<pst_reg->c_count; j++ )
+    {
+        if( pst_reg->pfn_callbList[j] == pfn_callback )
+        {
+            LOG_ERR(" (%d) already registered\n\r",c_eventType);
+            return E_FUNC_IN_LIST;
         }
     }
 
-    LOG_ERR("unknown event type (0x%02X)\n\r", c_eventType);
-    return E_UNKNOWN_TYPE;
+    if( pst_reg->c_count >= MAX_CALLBACK_COUNT )
+    {
+        /* If end of the registration list has been reached generate
+         * an error. */
+        LOG_ERR("limit is reached (%d)\n\r", MAX_CALLBACK_COUNT);
+        return E_END_OF_LIST;
+    }
+
+    /* Given function pointer for a given event type has been added */
+    LOG_INFO("new callback for (%d) event with callback %p\n\r", c_eventType, (void*)pfn_callback);
+    pst_reg->pfn_callbList[pst_reg->c_count++] = pfn_callback;
+    return E_SUCCESS;
 
 } /* evproc_regCallback() */
 
@@ -367,36 +589,46 @@ en_evprocResCode_t evproc_regCallback( c_event_t c_eventType,
 */
 en_evprocResCode_t evproc_unregCallback(c_event_t c_eventType, pfn_callback_t pfn_callback)
 {
-    uint8_t i,j;
+    uint8_t j;
+    st_funcReg_t* pst_reg;
+    st_evprocDispatch_t* ps_disp;
 
-    /* Search for a given event type and try to add given function pointer
-     * to the end of a registration list */
-    for( i = 0; i < EVENT_TYPE_MAX; i++ )
+    /* The registration list is indexed by the event type */
+    if( c_eventType >= EVENT_TYPE_MAX )
+    {
+        LOG_ERR(" unknown event type (0x%04X)\n\r", c_eventType);
+        return E_UNKNOWN_TYPE;
+    }
+    pst_reg = &pst_regList[c_eventType];
+
+    for( j=0; j<pst_reg->c_count; j++ )
     {
-        /* Find given c_eventType in registered list. If no event matches
-         * then generate error code */
-        if( pst_regList[i].c_event == c_eventType )
+        /* If "j" callback is equal to a given function pointer
+         * it means that this function for a given event has been
+         * found. Keep the list contiguous and in order by moving the
+         * following entries down. */
+        if( pst_reg->pfn_callbList[j] == pfn_callback )
         {
-            /* Event type has been found, now search for registered callbacks */
-            for( j=0; j<MAX_CALLBACK_COUNT; j++ )
+            pst_reg->c_count--;
+            memmove( &pst_reg->pfn_callbList[j], &pst_reg->pfn_callbList[j + 1],
+                    (pst_reg->c_count - j) * sizeof(pfn_callback_t) );
+            pst_reg->pfn_callbList[pst_reg->c_count] = NULL;
+
+            /* Dispatches of this type in progress that already called the
+             * removed callback continue with the entry moved into its slot */
+            for( ps_disp = ps_dispatch; ps_disp != NULL; ps_disp = ps_disp->p_next )
             {
-                /* If "j" callback is equal to a given function pointer
-                 * it means that this function for a given event has been
-                 * found. */
-                if( pst_regList[i].pfn_callbList[j] == pfn_callback )
+                if( (ps_disp->c_event == c_eventType) && (ps_disp->i_idx >= j) )
                 {
-                    pst_regList[i].pfn_callbList[j] = NULL;
-                    return E_SUCCESS;
+                    ps_disp->i_idx--;
                 }
             }
-
-            LOG_ERR("%s\n\r","function wasn't registered");
-            return E_NO_SUCH_FUNC;
+            return E_SUCCESS;
         }
     }
 
-    LOG_ERR(" unknown event type (0x%04X)\n\r", c_eventType);
-    return E_UNKNOWN_TYPE;
+    LOG_ERR("%s\n\r","function wasn't registered");
+    return E_NO_SUCH_FUNC;
 
 } /* evproc_unregCallback() */
 
@@ -408,55 +640,79 @@ en_evprocResCode_t evproc_unregCallback(c_event_t c_eventType, pfn_callback_t pf
 en_evprocResCode_t evproc_putEvent( en_evprocAction_t e_actType,
     c_event_t c_eventType, p_data_t p_data )
 {
-    int8_t i;
+    /* event is dispatched to every registered callback */
+    return evproc_putTargetEvent( e_actType, c_eventType, p_data, NULL );
+
+} /* evproc_putEvent() */
+
+
+/*---------------------------------------------------------------------------*/
+/*
+* evproc_putTargetEvent()
+*/
+en_evprocResCode_t evproc_putTargetEvent( en_evprocAction_t e_actType,
+    c_event_t c_eventType, p_data_t p_data, pfn_callback_t pfn_target )
+{
+    uint16_t i_idx;
+    st_eventDisc_t* pst_ev;
+    st_evQueue_t* pst_queue;
+
     bsp_enterCritical();
 
     switch (e_actType)
     {
         case  E_EVPROC_HEAD:
-            if (c_queueSize == EVPROC_QUEUE_SIZE)
+        case  E_EVPROC_TAIL:
+            if (c_eventType >= EVENT_TYPE_MAX)
             {
                 bsp_exitCritical();
-                return E_END_OF_LIST;
+                LOG_ERR("unknown type (0x%04X)\n\r", c_eventType);
+                return E_UNKNOWN_TYPE;
             }
 
             if ((c_eventType < OBLIG_EVENT_PRIOR) &&
-                    (_evproc_lookupEvent(c_eventType,p_data)))
+                (_evproc_lookupEvent(c_eventType,p_data,pfn_target)))
             {
                 /* Event has low priority and already in a queue */
+                bsp_exitCritical();
+                break;
             }
-            else
-            {
-                LOG_INFO("head %d : %p\n\r",c_eventType,p_data);
-                pst_evList[c_queueSize].c_event = c_eventType;
-                pst_evList[c_queueSize].p_data = p_data;
-                c_queueSize++;
-            }
-            bsp_exitCritical();
-            break;
 
-        case  E_EVPROC_TAIL:
-            if (c_queueSize == EVPROC_QUEUE_SIZE)
+            pst_queue = &pst_evQueue[pc_evPrio[c_eventType]];
+            if (pst_queue->i_count == EVPROC_QUEUE_SIZE)
             {
+                EVPROC_STAT_DROP();
                 bsp_exitCritical();
+                LOG_ERR("queue full, drop %d : %p\n\r",c_eventType,p_data);
                 return E_END_OF_LIST;
             }
-            if ((c_eventType < OBLIG_EVENT_PRIOR) &&
-                    (_evproc_lookupEvent(c_eventType,p_data))) {
-                /* Event has low priority and already in a queue */
+
+            if (e_actType == E_EVPROC_HEAD)
+            {
+                /* the head moves one slot backwards */
+                LOG_INFO("head %d : %p\n\r",c_eventType,p_data);
+                pst_queue->i_head = (pst_queue->i_head - 1U) & EVPROC_QUEUE_MASK;
+                i_idx = pst_queue->i_head;
+            }
+            else
+            {
+                LOG_INFO("tail %d : %p\n\r",c_eventType,p_data);
+                i_idx = (pst_queue->i_head + pst_queue->i_count) & EVPROC_QUEUE_MASK;
             }
-            else {
 
-                for (i=c_queueSize; i > 0; i--)
-                {
-                    pst_evList[i].c_event = pst_evList[i - 1].c_event;
-                    pst_evList[i].p_data = pst_evList[i - 1].p_data;
-                }
+            pst_ev = &pst_queue->pst_evList[i_idx];
+            pst_ev->c_event = c_eventType;
+            pst_ev->p_data = p_data;
+            pst_ev->pfn_target = pfn_target;
+            pst_queue->i_count++;
+            if (pst_queue->i_count > pst_queue->i_maxCount)
+            {
+                pst_queue->i_maxCount = pst_queue->i_count;
+            }
 
-                LOG_INFO("tail %d : %p\n\r",c_eventType,p_data);
-                pst_evList[0].c_event = c_eventType;
-                pst_evList[0].p_data = p_data;
-                c_queueSize++;
+            if (c_eventType < OBLIG_EVENT_PRIOR)
+            {
+                pc_evFilter[_evproc_filterIdx(c_eventType, p_data, pfn_target)]++;
             }
             bsp_exitCritical();
             break;
@@ -464,7 +720,7 @@ en_evprocResCode_t evproc_putEvent( en_evprocAction_t e_actType,
         case  E_EVPROC_EXEC:
             LOG_INFO("Execute event %d\n\r",c_eventType);
             bsp_exitCritical();
-            if (!_evproc_processEvent(c_eventType,p_data))
+            if (!_evproc_processEvent(c_eventType,p_data,pfn_target))
             {
                 return E_UNKNOWN_TYPE;
             }
@@ -477,7 +733,7 @@ en_evprocResCode_t evproc_putEvent( en_evprocAction_t e_actType,
     }
     return E_SUCCESS;
 
-} /* evproc_putEvent() */
+} /* evproc_putTargetEvent() */
 
 
 /*---------------------------------------------------------------------------*/
@@ -486,34 +742,128 @@ en_evprocResCode_t evproc_putEvent( en_evprocAction_t e_actType,
 */
 en_evprocResCode_t evproc_nextEvent(void)
 {
-    st_eventDisc_t nextEvent = { 0, NULL };
-    uint8_t i;
+    st_eventDisc_t nextEvent = { 0, NULL, NULL };
+    st_eventDisc_t* pst_ev;
+    st_evQueue_t* pst_queue = NULL;
+    uint16_t i;
+    uint8_t j;
 
-    if (c_queueSize > 0)
-    {
-        bsp_enterCritical();
+    bsp_enterCritical();
 
-        LOG_INFO("%s\n\r", "Event queue");
-        for( i = 0; i < c_queueSize; i++ )
+    /* serve the non-empty queue of the highest priority class */
+    for( j = 0; j < E_EVPROC_PRIO_MAX; j++ )
+    {
+        if (pst_evQueue[j].i_count > 0)
         {
-            LOG_RAW("%d | ev = %d : %p\n\r", i, pst_evList[i].c_event, pst_evList[i].p_data);
+            pst_queue = &pst_evQueue[j];
+            break;
         }
+    }
 
-        nextEvent.c_event = pst_evList[c_queueSize - 1].c_event;
-        nextEvent.p_data = pst_evList[c_queueSize - 1].p_data;
-        pst_evList[c_queueSize - 1].c_event = 0;
-        pst_evList[c_queueSize - 1].p_data = NULL;
-        c_queueSize--;
-
+    if (pst_queue == NULL)
+    {
         bsp_exitCritical();
+        return E_QUEUE_EMPTY;
+    }
 
-        if (!_evproc_processEvent(nextEvent.c_event, nextEvent.p_data))
-        {
-            return E_UNKNOWN_TYPE;
-        }
-        return E_SUCCESS;
+    LOG_INFO("Event queue %d\n\r", j);
+    for( i = 0; i < pst_queue->i_count; i++ )
+    {
+        pst_ev = &pst_queue->pst_evList[(pst_queue->i_head + i) & EVPROC_QUEUE_MASK];
+        LOG_RAW("%d | ev = %d : %p\n\r", i, pst_ev->c_event, pst_ev->p_data);
+    }
+
+    /* take the event from the head of the queue */
+    pst_ev = &pst_queue->pst_evList[pst_queue->i_head];
+    nextEvent = *pst_ev;
+    pst_ev->c_event = EVENT_TYPE_NONE;
+    pst_ev->p_data = NULL;
+    pst_ev->pfn_target = NULL;
+    pst_queue->i_head = (pst_queue->i_head + 1U) & EVPROC_QUEUE_MASK;
+    pst_queue->i_count--;
+
+    if (nextEvent.c_event < OBLIG_EVENT_PRIOR)
+    {
+        pc_evFilter[_evproc_filterIdx(nextEvent.c_event, nextEvent.p_data,
+                nextEvent.pfn_target)]--;
     }
-    return E_QUEUE_EMPTY;
+
+    bsp_exitCritical();
+
+    if (!_evproc_processEvent(nextEvent.c_event, nextEvent.p_data,
+            nextEvent.pfn_target))
+    {
+        return E_UNKNOWN_TYPE;
+    }
+    return E_SUCCESS;
 
 } /* evproc_nextEvent() */
 
+
+/*---------------------------------------------------------------------------*/
+/*
+* evproc_getQueueStat()
+*/
+en_evprocResCode_t evproc_getQueueStat( en_evprocPrio_t e_prio,
+    st_evprocQueueStat_t* ps_stat )
+{
+    if ((e_prio >= E_EVPROC_PRIO_MAX) || (ps_stat == NULL))
+    {
+        return E_INVALID_PARAM;
+    }
+
+    bsp_enterCritical();
+    ps_stat->i_depth = pst_evQueue[e_prio].i_count;
+    ps_stat->i_maxDepth = pst_evQueue[e_prio].i_maxCount;
+    bsp_exitCritical();
+
+    return E_SUCCESS;
+
+} /* evproc_getQueueStat() */
+
+
+#if (EVPROC_STATS == TRUE)
+/*---------------------------------------------------------------------------*/
+/*
+* evproc_getStats()
+*/
+en_evprocResCode_t evproc_getStats( st_evprocStats_t* ps_stats )
+{
+    uint8_t j;
+
+    if (ps_stats == NULL)
+    {
+        return E_INVALID_PARAM;
+    }
+
+    bsp_enterCritical();
+    *ps_stats = s_stats;
+    for( j = 0; j < E_EVPROC_PRIO_MAX; j++ )
+    {
+        ps_stats->pi_maxDepth[j] = pst_evQueue[j].i_maxCount;
+    }
+    bsp_exitCritical();
+
+    return E_SUCCESS;
+
+} /* evproc_getStats() */
+
+
+/*---------------------------------------------------------------------------*/
+/*
+* evproc_resetStats()
+*/
+void evproc_resetStats( void )
+{
+    uint8_t j;
+
+    bsp_enterCritical();
+    memset( &s_stats, 0, sizeof(s_stats) );
+    for( j = 0; j < E_EVPROC_PRIO_MAX; j++ )
+    {
+        pst_evQueue[j].i_maxCount = pst_evQueue[j].i_count;
+    }
+    bsp_exitCritical();
+
+} /* evproc_resetStats() */
+#endif /* #if (EVPROC_STATS == TRUE) */
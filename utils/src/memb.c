@@ -46,12 +46,222 @@
 
 #include "memb.h"
 
+#if MEMB_STATS
+#include <stdio.h>
+
+/* Head of the list of the registered memory blocks. */
+static struct memb *memb_registry;
+
+static void memb_stat_register(struct memb *m);
+static void memb_stat_alloc(struct memb *m, int n);
+
+#define MEMB_STAT_INIT(m)       do { memb_stat_register(m); (m)->used = 0; } while(0)
+#define MEMB_STAT_ALLOC(m, n)   memb_stat_alloc((m), (n))
+#define MEMB_STAT_FAIL(m)       do { memb_stat_register(m); ++((m)->fails); } while(0)
+#define MEMB_STAT_FREE(m)       do { if((m)->used > 0) { --((m)->used); } } while(0)
+#else
+#define MEMB_STAT_INIT(m)
+#define MEMB_STAT_ALLOC(m, n)
+#define MEMB_STAT_FAIL(m)
+#define MEMB_STAT_FREE(m)
+#endif /* MEMB_STATS */
+
+#if MEMB_STATS
+/*---------------------------------------------------------------------------*/
+/* Add a memory block to the registry on its first use. Memory blocks
+   declared with MEMB() are static, hence they cannot register themselves
+   before they are used. */
+static void
+memb_stat_register(struct memb *m)
+{
+  if(!m->registered) {
+    m->registered = 1;
+    m->reg_next = memb_registry;
+    memb_registry = m;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+memb_stat_alloc(struct memb *m, int n)
+{
+  memb_stat_register(m);
+  if(n > 0) {
+    m->used += n;
+  }
+  if(m->used > m->peak) {
+    m->peak = m->used;
+  }
+}
+#endif /* MEMB_STATS */
+
+#if MEMB_FAST
+/*---------------------------------------------------------------------------*/
+/* Get the index of the block "ptr" points to or -1 if it does not point to
+   the beginning of a block. */
+static int
+memb_index(struct memb *m, void *ptr)
+{
+  unsigned long offset;
+
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+  offset = (unsigned long)((char *)ptr - (char *)m->mem);
+  if(offset % m->size != 0) {
+    return -1;
+  }
+  return (int)(offset / m->size);
+}
+/*---------------------------------------------------------------------------*/
+/* Put a block that became free onto the stack of freed blocks. */
+static void
+memb_push(struct memb *m, unsigned short i)
+{
+  m->pos[i] = m->nfree;
+  m->free[m->nfree++] = i;
+}
+/*---------------------------------------------------------------------------*/
+/* Take a freed block out of the middle of the stack of freed blocks. */
+static void
+memb_remove(struct memb *m, unsigned short i)
+{
+  unsigned short last;
+
+  last = m->free[--m->nfree];
+  m->free[m->pos[i]] = last;
+  m->pos[last] = m->pos[i];
+}
+/*---------------------------------------------------------------------------*/
+void
+memb_init(struct memb *m)
+{
+  memset(m->count, 0, m->num);
+  memset(m->mem, 0, m->size * m->num);
+  m->nfree = 0;
+  m->next = 0;
+  MEMB_STAT_INIT(m);
+}
+/*---------------------------------------------------------------------------*/
+void *
+memb_alloc(struct memb *m)
+{
+  unsigned short i;
+
+  if(m->nfree > 0) {
+    /* Reuse the block that was freed last. */
+    i = m->free[--m->nfree];
+  } else if(m->next < m->num) {
+    /* Hand out a block that has never been allocated. */
+    i = m->next++;
+  } else {
+    /* No free block left, so we return NULL to indicate failure to
+       allocate block. */
+    MEMB_STAT_FAIL(m);
+    return NULL;
+  }
+
+  ++(m->count[i]);
+  MEMB_STAT_ALLOC(m, 1);
+  return (void *)((char *)m->mem + (i * m->size));
+}
+/*---------------------------------------------------------------------------*/
+void *
+memb_allocm(struct memb *m, int n)
+{
+  int i;
+  int j;
+
+  for(i = 0; i < m->num; ++i) {
+    if(m->count[i] == 0) {
+
+      /* we found an unused block and can start from here */
+      for(j = 0; (((j + i) < m->num) && (j < n)); j++ ) {
+        if( m->count[i+j] != 0 ) {
+          /* block is occupied ... break and restart with next
+           * free block.*/
+          break;
+        }
+      }
+
+      if( j < n ) {
+        /* block was not available. */
+        i += j;
+        continue;
+      }
+
+      /* Whole free block was found. All the blocks from m->next on are
+         free, hence the first free run never starts behind m->next and
+         no block that has never been allocated is skipped. */
+      for( j = 0; j < n; j++ ) {
+        if((i + j) < m->next) {
+          memb_remove(m, i + j);
+        }
+        ++(m->count[i+j]);
+      }
+      if((i + n) > m->next) {
+        m->next = i + n;
+      }
+      MEMB_STAT_ALLOC(m, n);
+
+      return (void *)((char *)m->mem + (i * m->size));
+    }
+  }
+
+  /* No free block was found, so we return NULL to indicate failure to
+     allocate block. */
+  MEMB_STAT_FAIL(m);
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+char
+memb_free(struct memb *m, void *ptr)
+{
+  int i;
+
+  i = memb_index(m, ptr);
+  if(i < 0) {
+    return -1;
+  }
+
+  /* Make sure that we don't deallocate free memory. */
+  if(m->count[i] > 0) {
+    if(--(m->count[i]) == 0) {
+      memb_push(m, i);
+      MEMB_STAT_FREE(m);
+    }
+  }
+  return m->count[i];
+}
+/*---------------------------------------------------------------------------*/
+char
+memb_freem(struct memb *m, void *ptr, int n)
+{
+  int i;
+  int j;
+
+  i = memb_index(m, ptr);
+  if(i < 0) {
+    return -1;
+  }
+
+  for( j = 0; (((i+j) < m->num) && (j < n)); j++ ) {
+    if(m->count[i+j] > 0) {
+      if(--(m->count[i+j]) == 0) {
+        memb_push(m, i + j);
+        MEMB_STAT_FREE(m);
+      }
+    }
+  }
+  return m->count[i];
+}
+#else
 /*---------------------------------------------------------------------------*/
 void
 memb_init(struct memb *m)
 {
   memset(m->count, 0, m->num);
   memset(m->mem, 0, m->size * m->num);
+  MEMB_STAT_INIT(m);
 }
 /*---------------------------------------------------------------------------*/
 void *
@@ -65,12 +275,14 @@ memb_alloc(struct memb *m)
      indicate that it now is used and return a pointer to the
      memory block. */
       ++(m->count[i]);
+      MEMB_STAT_ALLOC(m, 1);
       return (void *)((char *)m->mem + (i * m->size));
     }
   }
 
   /* No free block was found, so we return NULL to indicate failure to
      allocate block. */
+  MEMB_STAT_FAIL(m);
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -106,6 +318,7 @@ memb_allocm(struct memb *m, int n)
         /* whole free block was found. */
         for( j = 0; j < n; j++ )
           ++(m->count[i+j]);
+        MEMB_STAT_ALLOC(m, n);
 
         return (void *)((char *)m->mem + (i * m->size));
       }
@@ -114,6 +327,7 @@ memb_allocm(struct memb *m, int n)
 
   /* No free block was found, so we return NULL to indicate failure to
      allocate block. */
+  MEMB_STAT_FAIL(m);
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -134,6 +348,9 @@ memb_free(struct memb *m, void *ptr)
       if(m->count[i] > 0) {
     /* Make sure that we don't deallocate free memory. */
     --(m->count[i]);
+    if(m->count[i] == 0) {
+      MEMB_STAT_FREE(m);
+    }
       }
       return m->count[i];
     }
@@ -161,6 +378,9 @@ memb_freem(struct memb *m, void *ptr, int n)
       for( j = 0; (((i+j) < m->num) && (j < n)); j++ ) {
         if(m->count[i+j] > 0) {
           --(m->count[i+j]);
+          if(m->count[i+j] == 0) {
+            MEMB_STAT_FREE(m);
+          }
         }
       }
 
@@ -170,6 +390,7 @@ memb_freem(struct memb *m, void *ptr, int n)
   }
   return -1;
 }
+#endif /* MEMB_FAST */
 /*---------------------------------------------------------------------------*/
 int
 memb_inmemb(struct memb *m, void *ptr)
@@ -181,6 +402,9 @@ memb_inmemb(struct memb *m, void *ptr)
 int
 memb_numfree(struct memb *m)
 {
+#if MEMB_FAST
+  return m->nfree + (m->num - m->next);
+#else
   int i;
   int num_free = 0;
 
@@ -191,6 +415,49 @@ memb_numfree(struct memb *m)
   }
 
   return num_free;
+#endif /* MEMB_FAST */
+}
+
+#if MEMB_STATS
+/*---------------------------------------------------------------------------*/
+struct memb *
+memb_stats_list(void)
+{
+  return memb_registry;
+}
+/*---------------------------------------------------------------------------*/
+int
+memb_stats_print(char *buf, int len)
+{
+  struct memb *m;
+  int n;
+  int pos;
+
+  pos = snprintf(buf, len, "%-24s %5s %5s %5s %5s %5s\n",
+                 "pool", "size", "num", "used", "peak", "fail");
+  for(m = memb_registry; (m != NULL) && (pos >= 0) && (pos < len);
+      m = m->reg_next) {
+    n = snprintf(buf + pos, len - pos, "%-24s %5u %5u %5u %5u %5u\n",
+                 m->name, m->size, m->num, m->used, m->peak, m->fails);
+    if(n < 0) {
+      return -1;
+    }
+    pos += n;
+  }
+  return pos;
 }
+/*---------------------------------------------------------------------------*/
+void
+memb_stats_reset(void)
+{
+  struct memb *m;
+
+  for(m = memb_registry; m != NULL; m = m->reg_next) {
+    m->peak = m->used;
+    m->fails = 0;
+  }
+}
+#endif /* MEMB_STATS */
+/*---------------------------------------------------------------------------*/
 
 /** @} */
@@ -55,6 +55,287 @@
 #define MMEM_SIZE 4096
 #endif
 
+#if MMEM_SEGREGATED
+/* Smallest size class, payloads are rounded up to a power of two
+   multiple of it. It must be able to hold the free list link. */
+#ifdef MMEM_CONF_MIN_CLASS
+#define MMEM_MIN_CLASS MMEM_CONF_MIN_CLASS
+#else
+#define MMEM_MIN_CLASS 16
+#endif
+
+/* Number of size classes. */
+#ifdef MMEM_CONF_CLASSES
+#define MMEM_CLASSES MMEM_CONF_CLASSES
+#else
+#define MMEM_CLASSES 8
+#endif
+
+/* Size of the payload of a block of class c. */
+#define MMEM_CLASS_SIZE(c) ((unsigned int)MMEM_MIN_CLASS << (c))
+
+/* Header in front of every block carved from the arena. It allows the
+   compaction to walk the arena and to update the owners of the blocks
+   it moves. */
+struct mmem_hdr {
+  /* Owner of the block or NULL if the block is free. */
+  struct mmem *owner;
+  /* Size class of the block or MMEM_CLS_LARGE combined with the payload
+     size in pointers. */
+  unsigned short cls;
+};
+
+/* Flag of the blocks that are carved with the exact requested size
+   instead of a size class. */
+#define MMEM_CLS_LARGE 0x8000u
+
+/* Size of the header, keeping the payload aligned to a pointer. */
+#define MMEM_HDR_SIZE \
+  ((sizeof(struct mmem_hdr) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+/* Total size of a block of class c. */
+#define MMEM_BLOCK_SIZE(c) (MMEM_HDR_SIZE + MMEM_CLASS_SIZE(c))
+
+/* Total size of an exactly sized block with the given payload size. */
+#define MMEM_LARGE_SIZE(size) \
+  (MMEM_HDR_SIZE + (((size) + sizeof(void *) - 1) & ~(sizeof(void *) - 1)))
+
+#if (MMEM_SIZE / 4) >= MMEM_CLS_LARGE
+#error "MMEM_SIZE is too large for the block headers"
+#endif
+
+unsigned int avail_memory;
+static void *memory[MMEM_SIZE / sizeof(void *)];
+#define MMEM_ARENA ((char *)memory)
+
+/* Start of the part of the arena that has never been carved into blocks. */
+static unsigned int top;
+/* Free blocks per size class, linked through their payload. */
+static void *freelist[MMEM_CLASSES];
+/* Bytes held by free blocks in the free lists. */
+static unsigned int parked;
+
+/*---------------------------------------------------------------------------*/
+static unsigned int
+mmem_block_size(const struct mmem_hdr *h)
+{
+  if(h->cls & MMEM_CLS_LARGE) {
+    return MMEM_HDR_SIZE + (h->cls & ~MMEM_CLS_LARGE) * sizeof(void *);
+  }
+  return MMEM_BLOCK_SIZE(h->cls);
+}
+/*---------------------------------------------------------------------------*/
+static int
+mmem_class(unsigned int size)
+{
+  int c;
+
+  for(c = 0; c < MMEM_CLASSES; c++) {
+    if(size <= MMEM_CLASS_SIZE(c)) {
+      return c;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+/* Take a block of at least class c, return its header or NULL. */
+static struct mmem_hdr *
+mmem_take(int c)
+{
+  struct mmem_hdr *h;
+  int i;
+
+  /* A freed block of the exact class. */
+  if(freelist[c] != NULL) {
+    h = (struct mmem_hdr *)((char *)freelist[c] - MMEM_HDR_SIZE);
+    freelist[c] = *(void **)freelist[c];
+    parked -= MMEM_BLOCK_SIZE(c);
+    return h;
+  }
+
+  /* A new block from the arena. */
+  if(top + MMEM_BLOCK_SIZE(c) <= sizeof(memory)) {
+    h = (struct mmem_hdr *)(MMEM_ARENA + top);
+    h->cls = c;
+    top += MMEM_BLOCK_SIZE(c);
+    return h;
+  }
+
+  /* A freed block of a larger class, wasting at most the difference. */
+  for(i = c + 1; i < MMEM_CLASSES; i++) {
+    if(freelist[i] != NULL) {
+      return mmem_take(i);
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Carve a block of exactly the given size from the arena, return its
+   header or NULL. */
+static struct mmem_hdr *
+mmem_take_large(unsigned int size)
+{
+  struct mmem_hdr *h;
+  unsigned int len;
+
+  len = MMEM_LARGE_SIZE(size);
+  if(top + len > sizeof(memory)) {
+    return NULL;
+  }
+  h = (struct mmem_hdr *)(MMEM_ARENA + top);
+  h->cls = MMEM_CLS_LARGE | ((len - MMEM_HDR_SIZE) / sizeof(void *));
+  top += len;
+  return h;
+}
+/*---------------------------------------------------------------------------*/
+/* Take a block for a request of the given size, return its header or
+   NULL. */
+static struct mmem_hdr *
+mmem_take_any(unsigned int size)
+{
+  struct mmem_hdr *h = NULL;
+  int c;
+
+  c = mmem_class(size);
+  if(c >= 0) {
+    h = mmem_take(c);
+  }
+  if(h == NULL) {
+    /* Requests beyond the largest class and requests whose class does
+       not fit anymore get a block of their exact size. */
+    h = mmem_take_large(size);
+  }
+  return h;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Allocate a managed memory block
+ * \param m    A pointer to a struct mmem.
+ * \param size The size of the requested memory block
+ * \return     Non-zero if the memory could be allocated, zero if memory
+ *             was not available.
+ *
+ *             The size is rounded up to the next size class. A freed
+ *             block of that class is reused, otherwise a new block is
+ *             carved from the arena. Requests larger than the largest
+ *             class, or whose class block does not fit anymore, are
+ *             carved with their exact size. If memory parked in the free
+ *             lists could hold the block the arena is compacted first.
+ */
+int
+mmem_alloc(struct mmem *m, unsigned int size)
+{
+  struct mmem_hdr *h;
+
+  h = mmem_take_any(size);
+  if((h == NULL) &&
+     (parked + (sizeof(memory) - top) >= MMEM_LARGE_SIZE(size))) {
+    /* Only fragmentation prevents the allocation. */
+    mmem_compact();
+    h = mmem_take_any(size);
+  }
+  if(h == NULL) {
+    return 0;
+  }
+
+  h->owner = m;
+  m->next = NULL;
+  m->ptr = (char *)h + MMEM_HDR_SIZE;
+  m->size = size;
+  avail_memory -= mmem_block_size(h);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Deallocate a managed memory block
+ * \param m    A pointer to the managed memory block
+ *
+ *             The block is put to the free list of its size class, no
+ *             memory is moved. An exactly sized block returns to the
+ *             arena at once if it is the last carved block, otherwise it
+ *             is reclaimed by the next compaction.
+ */
+void
+mmem_free(struct mmem *m)
+{
+  struct mmem_hdr *h;
+  unsigned int len;
+
+  h = (struct mmem_hdr *)((char *)m->ptr - MMEM_HDR_SIZE);
+  h->owner = NULL;
+  len = mmem_block_size(h);
+  if(!(h->cls & MMEM_CLS_LARGE)) {
+    *(void **)m->ptr = freelist[h->cls];
+    freelist[h->cls] = m->ptr;
+    parked += len;
+  } else if((char *)h + len == MMEM_ARENA + top) {
+    top -= len;
+  } else {
+    parked += len;
+  }
+  avail_memory += len;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Compact the managed memory
+ *
+ *             All blocks in use are moved to the beginning of the arena
+ *             and their owners are updated, the free lists are emptied.
+ *             The time taken is proportional to the size of the carved
+ *             part of the arena, hence this function is meant to be
+ *             called when the system is idle. It returns immediately if
+ *             there is nothing to compact.
+ */
+void
+mmem_compact(void)
+{
+  struct mmem_hdr *h;
+  unsigned int src;
+  unsigned int dst;
+  unsigned int len;
+  int c;
+
+  if(parked == 0) {
+    return;
+  }
+
+  for(src = 0, dst = 0; src < top; src += len) {
+    h = (struct mmem_hdr *)(MMEM_ARENA + src);
+    len = mmem_block_size(h);
+    if(h->owner != NULL) {
+      if(dst != src) {
+        memmove(MMEM_ARENA + dst, MMEM_ARENA + src, len);
+        h = (struct mmem_hdr *)(MMEM_ARENA + dst);
+        h->owner->ptr = (char *)h + MMEM_HDR_SIZE;
+      }
+      dst += len;
+    }
+  }
+
+  top = dst;
+  parked = 0;
+  for(c = 0; c < MMEM_CLASSES; c++) {
+    freelist[c] = NULL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Initialize the managed memory module
+ */
+void
+mmem_init(void)
+{
+  int c;
+
+  top = 0;
+  parked = 0;
+  for(c = 0; c < MMEM_CLASSES; c++) {
+    freelist[c] = NULL;
+  }
+  avail_memory = sizeof(memory);
+}
+/*---------------------------------------------------------------------------*/
+#else
 LIST(mmemlist);
 unsigned int avail_memory;
 static char memory[MMEM_SIZE];
@@ -156,4 +437,6 @@ mmem_init(void)
 }
 /*---------------------------------------------------------------------------*/
 
+#endif /* MMEM_SEGREGATED */
+
 /** @} */
@@ -240,6 +240,68 @@ packetbuf_attr_copyfrom(struct packetbuf_attr *attrs,
   memcpy(packetbuf_attrs, attrs, sizeof(packetbuf_attrs));
   memcpy(packetbuf_addrs, addrs, sizeof(packetbuf_addrs));
 }
+#if PACKETBUF_ATTRS_PACKED
+/* The bitmap of packed attributes has a bit per attribute */
+typedef char packetbuf_attrs_packed_check[(PACKETBUF_NUM_ATTRS <= 32) ? 1 : -1];
+/*---------------------------------------------------------------------------*/
+int
+packetbuf_attr_pack(struct packetbuf_attrs_packed *p)
+{
+  uint32_t types;
+  uint8_t i, n;
+
+  /* check first, so that p is left unchanged if the attributes do not fit */
+  for(i = 0, n = 0, types = 0; i < PACKETBUF_NUM_ATTRS; ++i) {
+    if(packetbuf_attrs[i].val != 0) {
+      if(n == PACKETBUF_ATTRS_PACKED_NUM) {
+        return 0;
+      }
+      types |= (uint32_t)1 << i;
+      n++;
+    }
+  }
+  p->types = types;
+  for(i = 0, n = 0; types != 0; types >>= 1, ++i) {
+    if(types & 1) {
+      p->val[n++] = packetbuf_attrs[i].val;
+    }
+  }
+  memcpy(p->addrs, packetbuf_addrs, sizeof(packetbuf_addrs));
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_attr_unpack(const struct packetbuf_attrs_packed *p)
+{
+  uint32_t types;
+  uint8_t i, n;
+
+  memset(packetbuf_attrs, 0, sizeof(packetbuf_attrs));
+  for(types = p->types, i = 0, n = 0; types != 0; types >>= 1, ++i) {
+    if(types & 1) {
+      packetbuf_attrs[i].val = p->val[n++];
+    }
+  }
+  memcpy(packetbuf_addrs, p->addrs, sizeof(packetbuf_addrs));
+}
+/*---------------------------------------------------------------------------*/
+packetbuf_attr_t
+packetbuf_attr_packed(const struct packetbuf_attrs_packed *p, uint8_t type)
+{
+  uint32_t below;
+  uint8_t n;
+
+  if((type >= PACKETBUF_NUM_ATTRS) || !(p->types & ((uint32_t)1 << type))) {
+    return 0;
+  }
+  /* the index of the value is the number of stored attributes below it */
+  below = p->types & (((uint32_t)1 << type) - 1);
+  for(n = 0; below != 0; below &= below - 1) {
+    n++;
+  }
+  return p->val[n];
+}
+#endif /* PACKETBUF_ATTRS_PACKED */
 /*---------------------------------------------------------------------------*/
 #if !PACKETBUF_CONF_ATTRS_INLINE
 int
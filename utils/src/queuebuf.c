@@ -76,12 +76,23 @@ struct queuebuf {
 struct queuebuf_data {
   uint8_t data[PACKETBUF_SIZE];
   uint16_t len;
+#if PACKETBUF_ATTRS_PACKED
+  struct packetbuf_attrs_packed attrs;
+#else /* PACKETBUF_ATTRS_PACKED */
   struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
   struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+#endif /* PACKETBUF_ATTRS_PACKED */
+#if QUEUEBUF_REF
+  uint8_t ref;
+#endif /* QUEUEBUF_REF */
 };
 
 MEMB(bufmem, struct queuebuf, QUEUEBUF_NUM);
+#if QUEUEBUF_REF
+MEMB(buframmem, struct queuebuf_data, QUEUEBUF_DATA_NUM);
+#else /* QUEUEBUF_REF */
 MEMB(buframmem, struct queuebuf_data, QUEUEBUFRAM_NUM);
+#endif /* QUEUEBUF_REF */
 
 #if WITH_SWAP
 
@@ -278,6 +289,45 @@ queuebuf_load_to_ram(struct queuebuf *b)
 }
 #endif /* WITH_SWAP */
 /*---------------------------------------------------------------------------*/
+/* Store the attributes of the packetbuf with a queuebuf. Returns 0 if
+   they do not fit. */
+static int
+queuebuf_attr_store(struct queuebuf_data *d)
+{
+#if PACKETBUF_ATTRS_PACKED
+  if(!packetbuf_attr_pack(&d->attrs)) {
+    PRINTF("queuebuf: too many packetbuf attributes\n");
+    return 0;
+  }
+#else /* PACKETBUF_ATTRS_PACKED */
+  packetbuf_attr_copyto(d->attrs, d->addrs);
+#endif /* PACKETBUF_ATTRS_PACKED */
+  return 1;
+}
+#if QUEUEBUF_REF
+/*---------------------------------------------------------------------------*/
+/* Give a queuebuf its own copy of a shared payload before it is
+   modified. Returns NULL if no payload is left to copy to. */
+static struct queuebuf_data *
+queuebuf_unshare(struct queuebuf *b)
+{
+  struct queuebuf_data *d;
+
+  if(b->ram_ptr->ref > 1) {
+    d = memb_alloc(&buframmem);
+    if(d == NULL) {
+      PRINTF("queuebuf_unshare: could not copy queuebuf data\n");
+      return NULL;
+    }
+    memcpy(d, b->ram_ptr, sizeof(struct queuebuf_data));
+    b->ram_ptr->ref--;
+    d->ref = 1;
+    b->ram_ptr = d;
+  }
+  return b->ram_ptr;
+}
+#endif /* QUEUEBUF_REF */
+/*---------------------------------------------------------------------------*/
 void
 queuebuf_init(void)
 {
@@ -298,7 +348,13 @@ queuebuf_init(void)
 int
 queuebuf_numfree(void)
 {
+#if QUEUEBUF_REF
+  /* a new queuebuf needs a payload as well */
+  int n = memb_numfree(&buframmem);
+  return n < memb_numfree(&bufmem) ? n : memb_numfree(&bufmem);
+#else /* QUEUEBUF_REF */
   return memb_numfree(&bufmem);
+#endif /* QUEUEBUF_REF */
 }
 /*---------------------------------------------------------------------------*/
 #if QUEUEBUF_DEBUG
@@ -339,9 +395,25 @@ queuebuf_new_from_packetbuf(void)
     }
     buframptr = buf->ram_ptr;
 #endif
+#if QUEUEBUF_REF
+    buframptr->ref = 1;
+#endif /* QUEUEBUF_REF */
 
     buframptr->len = packetbuf_copyto(buframptr->data);
-    packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
+    if(!queuebuf_attr_store(buframptr)) {
+#if WITH_SWAP
+      if(buf->location == IN_RAM) {
+        memb_free(&buframmem, buf->ram_ptr);
+      }
+#else
+      memb_free(&buframmem, buf->ram_ptr);
+#endif
+#if QUEUEBUF_DEBUG
+      list_remove(queuebuf_list, buf);
+#endif /* QUEUEBUF_DEBUG */
+      memb_free(&bufmem, buf);
+      return NULL;
+    }
 
 #if WITH_SWAP
     if(buf->location == IN_CFS) {
@@ -366,30 +438,86 @@ queuebuf_new_from_packetbuf(void)
   }
   return buf;
 }
+#if QUEUEBUF_REF
 /*---------------------------------------------------------------------------*/
-void
+struct queuebuf *
+queuebuf_clone(struct queuebuf *b)
+{
+  struct queuebuf *buf;
+
+  if(!memb_inmemb(&bufmem, b)) {
+    return NULL;
+  }
+
+  buf = memb_alloc(&bufmem);
+  if(buf != NULL) {
+#if QUEUEBUF_DEBUG
+    list_add(queuebuf_list, buf);
+    buf->file = b->file;
+    buf->line = b->line;
+    buf->time = clock_time();
+#endif /* QUEUEBUF_DEBUG */
+    buf->ram_ptr = b->ram_ptr;
+    buf->ram_ptr->ref++;
+
+#if QUEUEBUF_STATS
+    ++queuebuf_len;
+    if(queuebuf_len > queuebuf_max_len) {
+      queuebuf_max_len = queuebuf_len;
+    }
+#endif /* QUEUEBUF_STATS */
+  } else {
+    PRINTF("queuebuf_clone: could not allocate a queuebuf\n");
+  }
+  return buf;
+}
+#endif /* QUEUEBUF_REF */
+/*---------------------------------------------------------------------------*/
+int
 queuebuf_update_attr_from_packetbuf(struct queuebuf *buf)
 {
+#if QUEUEBUF_REF
+  struct queuebuf_data *buframptr = queuebuf_unshare(buf);
+  if(buframptr == NULL) {
+    return 0;
+  }
+#else /* QUEUEBUF_REF */
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
-  packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
+#endif /* QUEUEBUF_REF */
+  if(!queuebuf_attr_store(buframptr)) {
+    PRINTF("queuebuf_update_attr_from_packetbuf: keeping old attributes\n");
+    return 0;
+  }
 #if WITH_SWAP
   if(buf->location == IN_CFS) {
     queuebuf_flush_tmpdata();
   }
 #endif
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
-void
+int
 queuebuf_update_from_packetbuf(struct queuebuf *buf)
 {
+#if QUEUEBUF_REF
+  struct queuebuf_data *buframptr = queuebuf_unshare(buf);
+  if(buframptr == NULL) {
+    return 0;
+  }
+#else /* QUEUEBUF_REF */
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
-  packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
+#endif /* QUEUEBUF_REF */
+  if(!queuebuf_attr_store(buframptr)) {
+    PRINTF("queuebuf_update_from_packetbuf: keeping old packet\n");
+    return 0;
+  }
   buframptr->len = packetbuf_copyto(buframptr->data);
 #if WITH_SWAP
   if(buf->location == IN_CFS) {
     queuebuf_flush_tmpdata();
   }
 #endif
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -402,6 +530,10 @@ queuebuf_free(struct queuebuf *buf)
     } else {
       queuebuf_remove_from_file(buf->swap_id);
     }
+#elif QUEUEBUF_REF
+    if(--buf->ram_ptr->ref == 0) {
+      memb_free(&buframmem, buf->ram_ptr);
+    }
 #else
     memb_free(&buframmem, buf->ram_ptr);
 #endif
@@ -422,7 +554,11 @@ queuebuf_to_packetbuf(struct queuebuf *b)
   if(memb_inmemb(&bufmem, b)) {
     struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
     packetbuf_copyfrom(buframptr->data, buframptr->len);
+#if PACKETBUF_ATTRS_PACKED
+    packetbuf_attr_unpack(&buframptr->attrs);
+#else /* PACKETBUF_ATTRS_PACKED */
     packetbuf_attr_copyfrom(buframptr->attrs, buframptr->addrs);
+#endif /* PACKETBUF_ATTRS_PACKED */
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -447,14 +583,22 @@ linkaddr_t *
 queuebuf_addr(struct queuebuf *b, uint8_t type)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
+#if PACKETBUF_ATTRS_PACKED
+  return &buframptr->attrs.addrs[type - PACKETBUF_ADDR_FIRST].addr;
+#else /* PACKETBUF_ATTRS_PACKED */
   return &buframptr->addrs[type - PACKETBUF_ADDR_FIRST].addr;
+#endif /* PACKETBUF_ATTRS_PACKED */
 }
 /*---------------------------------------------------------------------------*/
 packetbuf_attr_t
 queuebuf_attr(struct queuebuf *b, uint8_t type)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
+#if PACKETBUF_ATTRS_PACKED
+  return packetbuf_attr_packed(&buframptr->attrs, type);
+#else /* PACKETBUF_ATTRS_PACKED */
   return buframptr->attrs[type].val;
+#endif /* PACKETBUF_ATTRS_PACKED */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -57,10 +57,106 @@ s_rt_tmr_t *pTmrListTail;
 rt_tmr_qty_t TmrListQty;
 rt_tmr_tick_t TmrCurTick;
 
+#if (RT_TMR_CFG_HEAP_EN > 0u)
+/* binary min-heap of running timers, ordered by counter */
+static s_rt_tmr_t *TmrHeap[RT_TMR_CFG_HEAP_SIZE];
+#endif
+
 
 static void rt_tmr_link(s_rt_tmr_t *p_new);
 static void rt_tmr_unlink(s_rt_tmr_t *p_rem);
 
+#if (RT_TMR_CFG_HEAP_EN > 0u)
+static void rt_tmr_heapUp(rt_tmr_qty_t ix);
+static void rt_tmr_heapDown(rt_tmr_qty_t ix);
+
+
+/**
+ * @brief   Move a timer towards the root of the heap of timers.
+ * @param   ix      Heap index of the timer to move
+ */
+static void rt_tmr_heapUp(rt_tmr_qty_t ix)
+{
+  s_rt_tmr_t *p_tmr = TmrHeap[ix];
+  rt_tmr_qty_t parent;
+
+  while (ix > 0) {
+    parent = (ix - 1) / 2;
+    if (TmrHeap[parent]->counter <= p_tmr->counter) {
+      break;
+    }
+    TmrHeap[ix] = TmrHeap[parent];
+    TmrHeap[ix]->heapIx = ix;
+    ix = parent;
+  }
+  TmrHeap[ix] = p_tmr;
+  p_tmr->heapIx = ix;
+}
+
+/**
+ * @brief   Move a timer towards the leaves of the heap of timers.
+ * @param   ix      Heap index of the timer to move
+ */
+static void rt_tmr_heapDown(rt_tmr_qty_t ix)
+{
+  s_rt_tmr_t *p_tmr = TmrHeap[ix];
+  rt_tmr_qty_t child;
+
+  while ((child = 2 * ix + 1) < TmrListQty) {
+    if (((child + 1) < TmrListQty) &&
+        (TmrHeap[child + 1]->counter < TmrHeap[child]->counter)) {
+      child++;
+    }
+    if (TmrHeap[child]->counter >= p_tmr->counter) {
+      break;
+    }
+    TmrHeap[ix] = TmrHeap[child];
+    TmrHeap[ix]->heapIx = ix;
+    ix = child;
+  }
+  TmrHeap[ix] = p_tmr;
+  p_tmr->heapIx = ix;
+}
+
+/**
+ * @brief   Add a timer to the heap of timers.
+ * @param   p_tmr   Point to timer to add
+ */
+static void rt_tmr_link(s_rt_tmr_t *p_new)
+{
+  /* the caller guarantees that the heap is not full */
+  TmrHeap[TmrListQty] = p_new;
+  p_new->heapIx = TmrListQty;
+  TmrListQty++;
+  rt_tmr_heapUp(p_new->heapIx);
+
+  /* the head always refers to the timer expiring next */
+  pTmrListHead = TmrHeap[0];
+}
+
+/**
+ * @brief   Remove a timer from the heap of timers
+ * @param   p_tmr   Point to timer to remove
+ */
+static void rt_tmr_unlink(s_rt_tmr_t *p_rem)
+{
+  rt_tmr_qty_t ix = p_rem->heapIx;
+
+  /* fill the gap with the last timer of the heap */
+  TmrListQty--;
+  if (ix < TmrListQty) {
+    TmrHeap[ix] = TmrHeap[TmrListQty];
+    TmrHeap[ix]->heapIx = ix;
+    rt_tmr_heapUp(ix);
+    rt_tmr_heapDown(ix);
+  }
+  TmrHeap[TmrListQty] = (s_rt_tmr_t *)0;
+
+  pTmrListHead = (TmrListQty > 0) ? TmrHeap[0] : (s_rt_tmr_t *)0;
+}
+
+#else
+
 /**
  * @brief   Add a timer to the double-linked list of timers.
  * @param   p_tmr   Point to timer to add
@@ -147,6 +243,7 @@ static void rt_tmr_unlink(s_rt_tmr_t *p_rem)
   p_rem->pprev = (s_rt_tmr_t *)0;
   TmrListQty--;
 }
+#endif /* RT_TMR_CFG_HEAP_EN */
 
 /**
  * @brief Initialize timer management module
@@ -192,12 +289,22 @@ void rt_tmr_create(s_rt_tmr_t *p_tmr, e_rt_tmr_type_t type, rt_tmr_tick_t period
  *          list of timer.
  *
  * @param   p_tmr
+ * @return  E_RT_TMR_ERR_FULL if the timer could not be started because
+ *          RT_TMR_CFG_HEAP_SIZE timers are running already, otherwise
+ *          E_RT_TMR_ERR_NONE
  */
-void rt_tmr_start(s_rt_tmr_t *p_tmr)
+e_rt_tmr_err_t rt_tmr_start(s_rt_tmr_t *p_tmr)
 {
   bsp_enterCritical();
   if ((p_tmr->state == E_RT_TMR_STATE_CREATED) ||
       (p_tmr->state == E_RT_TMR_STATE_STOPPED)) {
+#if (RT_TMR_CFG_HEAP_EN > 0u)
+    if (TmrListQty >= RT_TMR_CFG_HEAP_SIZE) {
+      /* no room left for another running timer */
+      bsp_exitCritical();
+      return E_RT_TMR_ERR_FULL;
+    }
+#endif
     /* update new counter */
     p_tmr->counter = TmrCurTick + p_tmr->period;
 
@@ -208,6 +315,7 @@ void rt_tmr_start(s_rt_tmr_t *p_tmr)
     p_tmr->state = E_RT_TMR_STATE_RUNNING;
   }
   bsp_exitCritical();
+  return E_RT_TMR_ERR_NONE;
 }
 
 /**
@@ -264,6 +372,16 @@ rt_tmr_tick_t rt_tmr_getRemain(s_rt_tmr_t *p_tmr)
   return (p_tmr->counter - TmrCurTick);
 }
 
+/**
+ * @brief   Achieve the running timer that expires next.
+ * @return  Point to the timer or NULL if no timer is running
+ */
+s_rt_tmr_t *rt_tmr_getNext(void)
+{
+  /* the head of the list respectively the root of the heap */
+  return pTmrListHead;
+}
+
 /**
  * @brief   Achieve current operating state of a timer.
  * @param   p_tmr   Point to the timer
@@ -311,3 +429,37 @@ void rt_tmr_update(void)
     }
   }
 }
+
+/**
+ * @brief   Advance the timer tick by several ticks at once, e.g. if the
+ *          system clock did not interrupt for a while. Ticks without an
+ *          expiring timer are skipped at once. The advance stops at the
+ *          first tick a timer expires at, that tick is processed as by
+ *          rt_tmr_update().
+ * @param   ticks   Number of ticks to advance
+ * @return  Number of ticks advanced, less than ticks if the advance
+ *          stopped at an expiring timer
+ */
+rt_tmr_tick_t rt_tmr_advance(rt_tmr_tick_t ticks)
+{
+  rt_tmr_tick_t rem;
+
+  if (ticks == 0) {
+    return 0;
+  }
+
+  if (pTmrListHead != (s_rt_tmr_t *)0) {
+    rem = (pTmrListHead->counter > TmrCurTick) ?
+          (pTmrListHead->counter - TmrCurTick) : 1;
+    if (rem <= ticks) {
+      /* skip to the tick before the expiration and let rt_tmr_update()
+       * process the expiring tick itself */
+      TmrCurTick += rem - 1;
+      rt_tmr_update();
+      return rem;
+    }
+  }
+
+  TmrCurTick += ticks;
+  return ticks;
+}